@@ -11,3 +11,12 @@ FOUNDATION_EXPORT const unsigned char SmokeAndMirrorsVersionString[];
 #import "RDInvocation.h"
 #import "RDBlockObject.h"
 #import "RDClassBuilder.h"
+#import "RDMetrics.h"
+#import "RDDescriber.h"
+#import "RDRuntimeIndex.h"
+#import "RDInvocationExecutor.h"
+#import "RDTemplates.h"
+#import "RDObjectGraphAnalyzer.h"
+#import "RDClone.h"
+#import "RDTypeConverter.h"
+#import "RDPropertyTable.h"
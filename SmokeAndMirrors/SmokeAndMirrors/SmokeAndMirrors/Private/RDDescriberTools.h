@@ -0,0 +1,62 @@
+#import <Foundation/Foundation.h>
+#import "RDDescriber.h"
+#import "RDSmoke.h"
+#import "RDMirror.h"
+
+#include <unordered_set>
+
+NS_ASSUME_NONNULL_BEGIN
+
+class RDDescriberStream {
+public:
+    RDDescriberOptions options = RDDescriberOptionsNone;
+    NSUInteger maxDepth = 8;
+    NSUInteger maxElements = 128;
+    RDSmoke *_Nullable smoke = nil;
+
+    RDDescriberStream() = default;
+    ~RDDescriberStream();
+
+    RDDescriberStream(const RDDescriberStream &) = delete;
+    RDDescriberStream &operator=(const RDDescriberStream &) = delete;
+
+    void write(const char *string, size_t length);
+    void write(const char *string) { write(string, strlen(string)); }
+    void write(char c) { reserve(1); _buffer[_length++] = c; _buffer[_length] = '\0'; }
+    void format(const char *format, ...) __printflike(2, 3);
+    void newline();
+    void separator();
+
+    bool enter() { return _depth < maxDepth ? (++_depth, true) : false; }
+    void leave() { --_depth; }
+    NSUInteger depth() const { return _depth; }
+
+    void writeObject(__unsafe_unretained id _Nullable object);
+    void writeBytes(const void *bytes, RDType *type);
+
+    void begin() { _visited.clear(); _depth = 0; }
+    void end() { if (_fd >= 0) flush(); }
+
+    bool flush();
+    void reset() { _length = 0; if (_buffer != NULL) _buffer[0] = '\0'; }
+
+    void attach(int fd) { flush(); _fd = fd; }
+    int fileDescriptor() const { return _fd; }
+    size_t length() const { return _length; }
+    const char *string() const { return _buffer ?: ""; }
+
+private:
+    int _fd = -1;
+    bool _failed = false;
+    char *_Nullable _buffer = NULL;
+    size_t _length = 0;
+    size_t _capacity = 0;
+    NSUInteger _depth = 0;
+    std::unordered_set<const void *> _visited;
+
+    void reserve(size_t extra);
+    bool writeReflection(__unsafe_unretained id object, Class cls);
+    void writeIvars(__unsafe_unretained id object, RDClass *mirror, NSUInteger &written, NSUInteger &skipped);
+};
+
+NS_ASSUME_NONNULL_END
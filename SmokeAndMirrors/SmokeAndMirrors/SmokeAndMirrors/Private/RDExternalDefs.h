@@ -1,4 +1,9 @@
 #import "RDPrivate.h"
+#import <Block.h>
+
+#ifndef BLOCK_EXPORT
+#define BLOCK_EXPORT RD_EXTERN
+#endif
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -20,12 +25,18 @@ RD_EXTERN id _Nullable objc_retainAutoreleasedReturnValue(id _Nullable value);
 RD_EXTERN id _Nullable objc_retainBlock(id _Nullable value);
 RD_EXTERN void objc_storeStrong(id _Nullable *_Nonnull object, id _Nullable value);
 RD_EXTERN id objc_storeWeak(id _Nullable *_Nonnull object, id _Nullable value);
+#if !__APPLE__
+RD_EXTERN size_t object_getRetainCount_np(id _Nullable value);
+#endif
 
 BLOCK_EXPORT void *_Nonnull _NSConcreteStackBlock[32];          // likely __NSStackBlock__
 BLOCK_EXPORT void *_Nonnull _NSConcreteMallocBlock[32];         // likely __NSMallocBlock__
+BLOCK_EXPORT void *_Nonnull _NSConcreteGlobalBlock[32];         // likely __NSGlobalBlock__
+#if __APPLE__
+// Only libclosure exports these
 BLOCK_EXPORT void *_Nonnull _NSConcreteAutoBlock[32];           // likely __NSAutoBlock__
 BLOCK_EXPORT void *_Nonnull _NSConcreteFinalizingBlock[32];     // likely __NSFinalizingBlock__
-BLOCK_EXPORT void *_Nonnull _NSConcreteGlobalBlock[32];         // likely __NSGlobalBlock__
 BLOCK_EXPORT void *_Nonnull _NSConcreteWeakBlockVariable[32];   // likely __NSBlockVariable__
+#endif
 
 NS_ASSUME_NONNULL_END
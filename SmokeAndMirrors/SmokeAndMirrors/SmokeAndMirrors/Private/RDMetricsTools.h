@@ -0,0 +1,78 @@
+#import <Foundation/Foundation.h>
+#import "RDMetrics.h"
+#import <ffi/ffi.h>
+
+#include <atomic>
+#include <chrono>
+
+NS_ASSUME_NONNULL_BEGIN
+
+struct RDMetricsThreadStorage {
+    std::atomic<uint64_t> counters[RDMetricsCounterCount];
+    std::atomic<uint64_t> timerCounts[RDMetricsTimerCount];
+    std::atomic<uint64_t> timerTotals[RDMetricsTimerCount];
+    std::atomic<uint64_t> timerBuckets[RDMetricsTimerCount][RDMetricsHistogramBucketCount];
+
+    RDMetricsThreadStorage();
+    ~RDMetricsThreadStorage();
+};
+
+extern std::atomic<bool> RDMetricsTimingEnabled;
+
+RDMetricsThreadStorage &RDMetricsCurrentThreadStorage(void);
+void RDMetricsReportParseFailure(const char *encoding, const char *failurePosition);
+
+// Storage is only ever written by its own thread, so plain load/store pairs are enough and avoid locked instructions
+static inline void RDMetricsBump(std::atomic<uint64_t> &value, uint64_t delta) {
+    value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+static inline void RDMetricsIncrement(RDMetricsCounter counter) {
+    RDMetricsBump(RDMetricsCurrentThreadStorage().counters[counter], 1);
+}
+
+static inline NSUInteger RDMetricsBucketForNanoseconds(uint64_t ns) {
+    NSUInteger bucket = ns == 0 ? 0 : 63 - __builtin_clzll(ns);
+    return MIN(bucket, RDMetricsHistogramBucketCount - 1);
+}
+
+class RDMetricsTimerScope {
+public:
+    explicit RDMetricsTimerScope(RDMetricsTimer timer)
+        : _timer(timer)
+        , _enabled(RDMetricsTimingEnabled.load(std::memory_order_relaxed))
+    {
+        if (_enabled)
+            _start = std::chrono::steady_clock::now();
+    }
+
+    ~RDMetricsTimerScope() {
+        if (!_enabled)
+            return;
+
+        auto elapsed = std::chrono::steady_clock::now() - _start;
+        uint64_t ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        RDMetricsThreadStorage &storage = RDMetricsCurrentThreadStorage();
+        RDMetricsBump(storage.timerCounts[_timer], 1);
+        RDMetricsBump(storage.timerTotals[_timer], ns);
+        RDMetricsBump(storage.timerBuckets[_timer][RDMetricsBucketForNanoseconds(ns)], 1);
+    }
+
+    RDMetricsTimerScope(const RDMetricsTimerScope &) = delete;
+    RDMetricsTimerScope &operator=(const RDMetricsTimerScope &) = delete;
+
+private:
+    RDMetricsTimer _timer;
+    bool _enabled;
+    std::chrono::steady_clock::time_point _start;
+};
+
+#define RD_METRICS_TIME(TIMER) RDMetricsTimerScope RD_MACRO_CONCATENATE(_metricsTimer, __COUNTER__)(TIMER)
+
+static inline ffi_status RDMetricsPrepCif(ffi_cif *cif, unsigned argCount, ffi_type *returnType, ffi_type *_Nullable *_Nullable argTypes) {
+    RDMetricsIncrement(RDMetricsCounterFFIPrepCif);
+    RD_METRICS_TIME(RDMetricsTimerFFIPrepCif);
+    return ffi_prep_cif(cif, FFI_DEFAULT_ABI, argCount, returnType, argTypes);
+}
+
+NS_ASSUME_NONNULL_END
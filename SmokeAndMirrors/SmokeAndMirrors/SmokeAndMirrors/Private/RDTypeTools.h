@@ -5,12 +5,15 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+class RDDescriberStream;
+
 @interface RDType(RDPrivate)
 
 - (void)_value_retainBytes:(void *)bytes;
 - (void)_value_releaseBytes:(void *)bytes;
 - (NSString *)_value_describeBytes:(void *)bytes additionalInfo:(nullable NSMutableArray<NSString *> *)info;
 - (NSString *)_value_formatWithBytes:(void *)bytes;
+- (void)_value_streamBytes:(const void *)bytes into:(RDDescriberStream &)stream;
 - (ffi_type *_Nullable)_ffi_type;
 + (void)_ffi_type_destroy:(ffi_type *)type;
 - (RDRetentionType)_defaultRetention;
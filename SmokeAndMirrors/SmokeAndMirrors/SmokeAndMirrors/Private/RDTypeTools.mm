@@ -23,6 +23,10 @@
     return [NSString stringWithFormat:@"%@ = %@;\n%@", decl, desc, [more componentsJoinedByString:@"\n\n"]];
 }
 
+- (void)_value_streamBytes:(const void *)__unused bytes into:(RDDescriberStream &)stream {
+    stream.write("<?>");
+}
+
 - (ffi_type *)_ffi_type {
     return NULL;
 }
@@ -102,6 +106,15 @@
         return @"nil";
 }
 
+- (void)_value_streamBytes:(const void *)bytes into:(RDDescriberStream &)stream {
+    if (void *ptr = *(void **)bytes; ptr == NULL)
+        stream.write("nil");
+    else if (self.kind == RDObjectTypeKindClass)
+        stream.format("%s.self", class_getName(object_getClass((__bridge id)bytes)));
+    else
+        stream.writeObject((__bridge id)ptr);
+}
+
 - (ffi_type *)_ffi_type {
     return &ffi_type_pointer;
 }
@@ -129,6 +142,10 @@
     return @"void";
 }
 
+- (void)_value_streamBytes:(const void *)__unused bytes into:(RDDescriberStream &)stream {
+    stream.write("void");
+}
+
 - (ffi_type *)_ffi_type {
     return &ffi_type_void;
 }
@@ -186,6 +203,58 @@
     return nil;
 }
 
+- (void)_value_streamBytes:(const void *)bytes into:(RDDescriberStream &)stream {
+    switch (self.kind) {
+        case RDPrimitiveTypeKindSelector:
+            if (SEL selector = *(SEL *)bytes; selector != NULL)
+                return stream.format("@selector(%s)", sel_getName(selector));
+            else
+                return stream.write("(SEL)0x0");
+        case RDPrimitiveTypeKindCString:
+            return stream.format("c string at \"%p\"", *(const char **)bytes);
+        case RDPrimitiveTypeKindAtom:
+            return stream.write("?");
+        case RDPrimitiveTypeKindChar:
+            if (char c = *(char *)bytes; isprint((unsigned char)c))
+                return stream.format("'%c'", c);
+            else
+                return stream.format("'\\x%02x'", (unsigned char)c);
+        case RDPrimitiveTypeKindUnsignedChar:
+            if (unsigned char c = *(unsigned char *)bytes; isprint(c))
+                return stream.format("(unsigned char)'%c'", c);
+            else
+                return stream.format("(unsigned char)'\\x%02x'", c);
+        case RDPrimitiveTypeKindBool:
+            return stream.write(*(unsigned char *)bytes ? "true" : "false");
+        case RDPrimitiveTypeKindShort:
+            return stream.format("(short)%d", *(short *)bytes);
+        case RDPrimitiveTypeKindUnsignedShort:
+            return stream.format("(unsigned short)%du", *(unsigned short *)bytes);
+        case RDPrimitiveTypeKindInt:
+            return stream.format("%d", *(int *)bytes);
+        case RDPrimitiveTypeKindUnsignedInt:
+            return stream.format("%du", *(unsigned int *)bytes);
+        case RDPrimitiveTypeKindLong:
+            return stream.format("%ldl", *(long *)bytes);
+        case RDPrimitiveTypeKindUnsignedLong:
+            return stream.format("%luul", *(unsigned long *)bytes);
+        case RDPrimitiveTypeKindLongLong:
+            return stream.format("%lldll", *(long long int *)bytes);
+        case RDPrimitiveTypeKindUnsignedLongLong:
+            return stream.format("%lluull", *(unsigned long long *)bytes);
+        case RDPrimitiveTypeKindInt128:
+            return stream.format("(int128_t)%lld", (long long)*(__int128_t *)bytes);
+        case RDPrimitiveTypeKindUnsignedInt128:
+            return stream.format("(uint128_t)%llu", (unsigned long long)*(__uint128_t *)bytes);
+        case RDPrimitiveTypeKindFloat:
+            return stream.format("%ff", *(float *)bytes);
+        case RDPrimitiveTypeKindDouble:
+            return stream.format("%f", *(double *)bytes);
+        case RDPrimitiveTypeKindLongDouble:
+            return stream.format("%Lfl", *(long double *)bytes);
+    }
+}
+
 - (ffi_type *)_ffi_type {
     static ffi_type *const boolType = ({
         #if OBJC_BOOL_IS_BOOL
@@ -250,6 +319,13 @@
     return [self.type _value_describeBytes:bytes additionalInfo:info];
 }
 
+- (void)_value_streamBytes:(const void *)bytes into:(RDDescriberStream &)stream {
+    if (self.kind == RDCompositeTypeKindPointer)
+        stream.format("(%s)%p", self.description.UTF8String, *(void **)bytes);
+    else
+        stream.writeBytes(bytes, self.type);
+}
+
 - (ffi_type *)_ffi_type {
     switch (self.kind) {
         case RDCompositeTypeKindPointer:
@@ -274,8 +350,6 @@
                 return NULL;
             
         case RDCompositeTypeKindAtomic:
-            return NULL;
-
         case RDCompositeTypeKindConst:
             return self.type._ffi_type;
     }
@@ -319,6 +393,26 @@
     return [NSString stringWithFormat:@"{ %@ }", [values componentsJoinedByString:@", "]];
 }
 
+- (void)_value_streamBytes:(const void *)bytes into:(RDDescriberStream &)stream {
+    if (!stream.enter())
+        return stream.write("{ ... }");
+
+    stream.write("{ ");
+    NSUInteger count = MIN(self.count, stream.maxElements);
+    for (NSUInteger i = 0; i < count; ++i) {
+        if (i > 0)
+            stream.write(", ");
+        if (RDOffset offset = [self offsetForElementAtIndex:i]; offset != RDOffsetUnknown)
+            stream.writeBytes((const uint8_t *)bytes + offset, self.type);
+        else
+            stream.write("<?>");
+    }
+    if (count < self.count)
+        stream.format("%s... %lu more", count > 0 ? ", " : "", (unsigned long)(self.count - count));
+    stream.write(" }");
+    stream.leave();
+}
+
 - (ffi_type *)_ffi_type {
     return &ffi_type_pointer;
 }
@@ -360,6 +454,36 @@
                                       [values componentsJoinedByString:@", "]];
 }
 
+- (void)_value_streamBytes:(const void *)bytes into:(RDDescriberStream &)stream {
+    stream.format("(%s%s%s) ", self.kind == RDAggregateTypeKindUnion ? "union" : "struct",
+                  self.name != nil ? " " : "", self.name.UTF8String ?: "");
+    if (!stream.enter())
+        return stream.write("{ ... }");
+
+    stream.write("{ ");
+    NSUInteger written = 0;
+    for (NSUInteger i = 0; i < self.count; ++i) {
+        RDField *field = [self fieldAtIndex:i];
+        if (field == NULL || field->offset == RDOffsetUnknown)
+            continue;
+
+        if (written == stream.maxElements) {
+            stream.format(", ... %lu more", (unsigned long)(self.count - i));
+            break;
+        }
+
+        if (written++ > 0)
+            stream.write(", ");
+        if (field->name != nil)
+            stream.format(".%s = ", field->name.UTF8String);
+        else
+            stream.format(".field%lu = ", (unsigned long)i);
+        stream.writeBytes((const uint8_t *)bytes + field->offset, field->type);
+    }
+    stream.write(" }");
+    stream.leave();
+}
+
 - (ffi_type *)_ffi_type {
     switch (self.kind) {
         case RDAggregateTypeKindUnion:
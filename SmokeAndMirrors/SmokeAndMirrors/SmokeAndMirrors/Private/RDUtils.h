@@ -1,10 +1,56 @@
 #import <Foundation/Foundation.h>
 #import <objc/runtime.h>
+#import <dispatch/dispatch.h>
+#if __APPLE__
+#import <malloc/malloc.h>
+#endif
 #include <algorithm>
 #include <numeric>
 
 NS_ASSUME_NONNULL_BEGIN
 
+static inline bool RDIsTaggedPointer(const void *_Nullable pointer) {
+#if !__LP64__
+    return false;
+#elif !__APPLE__
+    // libobjc2 small objects
+    return ((uintptr_t)pointer & 7) != 0;
+#elif (TARGET_OS_OSX || TARGET_OS_MACCATALYST) && __x86_64__
+    return ((uintptr_t)pointer & 1) != 0;
+#else
+    return ((intptr_t)pointer) < 0;
+#endif
+}
+
+// GNUstep's runtime keeps a header in front of each object, so the instance size is the best it can tell
+static inline size_t RDObjectAllocationSize(const void *object) {
+#if __APPLE__
+    return malloc_size(object);
+#else
+    return class_getInstanceSize(object_getClass((__bridge id)object));
+#endif
+}
+
+static inline size_t RDGoodAllocationSize(size_t size) {
+#if __APPLE__
+    return malloc_good_size(size);
+#else
+    return size;
+#endif
+}
+
+static inline dispatch_queue_t RDUtilityQueue(void) {
+#if __APPLE__
+    return dispatch_get_global_queue(QOS_CLASS_UTILITY, 0);
+#else
+    return dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0);
+#endif
+}
+
+static inline constexpr size_t RDAlignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
 template<typename T, typename U>
 NSArray<U *> *_Nullable map_nn(NSArray<T *> *_Nullable source, U *_Nullable (^_Nonnull block)(T *_Nonnull)) {
     if (source == nil)
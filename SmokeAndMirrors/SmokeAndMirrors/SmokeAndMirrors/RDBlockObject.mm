@@ -23,6 +23,9 @@ struct RDBlockObjectCapture {
 }
 
 void RDBlockObjectTramp(ffi_cif *, void *ret, void **args, void *cap) {
+    RDMetricsIncrement(RDMetricsCounterInvocation);
+    RD_METRICS_TIME(RDMetricsTimerInvocation);
+
     __unsafe_unretained id self = *(__autoreleasing id *)args[0];
     RDBlockObjectCapture *capture = (RDBlockObjectCapture *)cap;
     SEL selector = capture->selector;
@@ -76,7 +79,7 @@ RDBlockObjectCapture *RDBlockObjectCaptureForSelectorInClass(SEL selector, Class
         if (retType == NULL)
             return NULL;
         
-        if (ffi_prep_cif(&capture->cifExt, FFI_DEFAULT_ABI, (unsigned)extArgCount, retType, argTypes) != FFI_OK)
+        if (RDMetricsPrepCif(&capture->cifExt, (unsigned)extArgCount, retType, argTypes) != FFI_OK)
             return NULL;
     }
     
@@ -87,7 +90,7 @@ RDBlockObjectCapture *RDBlockObjectCaptureForSelectorInClass(SEL selector, Class
             argTypes[i] = capture->cifExt.arg_types[i + i];
         
         ffi_type *retType = capture->cifExt.rtype;
-        if (ffi_prep_cif(&capture->cifInt, FFI_DEFAULT_ABI, (unsigned)intArgCount, retType, argTypes) != FFI_OK)
+        if (RDMetricsPrepCif(&capture->cifInt, (unsigned)intArgCount, retType, argTypes) != FFI_OK)
             return NULL;
     }
     
@@ -147,7 +150,11 @@ RDBlockObjectCapture *RDBlockObjectCaptureForSelectorInClass(SEL selector, Class
         _invoke = (void (*)(id, ...))capture->fptr;
         _descriptor = &capture->descriptor;
     }
+#if __APPLE__
     return [self retain];
+#else
+    return self;
+#endif
 }
 
 - (instancetype)initWithCFunctionPointer:(void (*)(id, ...))fptr {
@@ -166,6 +173,8 @@ RDBlockObjectCapture *RDBlockObjectCaptureForSelectorInClass(SEL selector, Class
     // do nothing
 }
 
+#if __APPLE__
+// Lifetime is the block runtime's, counted in _flags; libobjc2 counts blocks elsewhere, so there instances keep NSObject's
 - (id)retain {
     return Block_copy(self);
 }
@@ -186,6 +195,7 @@ RDBlockObjectCapture *RDBlockObjectCaptureForSelectorInClass(SEL selector, Class
     // so we don't want NSObject to do the same; therefore, no [super dealloc];
 }
 #pragma clang diagnostic pop
+#endif
 
 - (void (^)(void))asBlock {
     return (id)self;
@@ -1,7 +1,9 @@
 #import "RDClassBuilder.h"
 #import "RDPrivate.h"
 #import "RDSmoke.h"
+#import <string>
 #import <unordered_map>
+#import <vector>
 
 #define VALUE(VALUE) (void)(error != NULL && (*error = nil)), (VALUE)
 #define ERROR(CODE) (void)(error != NULL && (*error = (CODE))), Nil
@@ -35,7 +37,7 @@ NSInteger const RDClassBuilderInvalidNameCode = 260;
 @interface RDCBProperty : NSObject
 @property (nonatomic, copy) NSString *name;
 @property (nonatomic, copy) RDType *type;
-@property (nonatomic, copy) RDPropertySignature *signature;
+@property (nonatomic) RDPropertySignature *signature;
 @end
 
 @implementation RDCBProperty : NSObject
@@ -61,12 +63,23 @@ NSInteger const RDClassBuilderInvalidNameCode = 260;
     return [[self alloc] initWithName:name];
 }
 
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _super = NSObject.self;
+        _ivars = [NSMutableDictionary new];
+        _methods = [NSMutableDictionary new];
+        _properties = [NSMutableDictionary new];
+        _protocols = [NSMutableDictionary new];
+    }
+    return self;
+}
+
 - (instancetype)initWithName:(NSString *)name {
     NSParameterAssert(name);
-    self = [super init];
+    self = [self init];
     if (self) {
         _name = name.copy;
-        _super = NSObject.self;
     }
     return self;
 }
@@ -154,13 +167,17 @@ NSInteger const RDClassBuilderInvalidNameCode = 260;
     if (name.length == 0)
         return ECODE(RDClassBuilderInvalidNameCode);
     
-    __unsafe_unretained Class cls = objc_allocateClassPair(self.superclass, name.UTF8String, 0);
+    __unsafe_unretained Class cls = objc_allocateClassPair(self.super, name.UTF8String, 0);
+
+    if (cls == Nil)
+        return ECODE(RDClassBuilderInvalidNameCode);
 
     if (NSError *err = nil; (void)[self _buildClass:cls error:&err], err == nil) {
         objc_registerClassPair(cls);
+        RDInvalidateClass(cls, self._touchedMembers);
         return VALUE(cls);
     } else {
-        objc_disposeClassPair(cls);
+        RDDisposeClass(cls);
         return ERROR(err);
     }
 }
@@ -175,7 +192,18 @@ NSInteger const RDClassBuilderInvalidNameCode = 260;
 }
 
 - (BOOL)buildUpon:(Class)cls error:(NSError *_Nullable *_Nullable)error {
-    return [self _buildClass:cls error:error] != Nil;
+    if ([self _buildClass:cls error:error] == Nil)
+        return NO;
+
+    RDInvalidateClass(cls, self._touchedMembers);
+    return YES;
+}
+
+- (RDClassMembers)_touchedMembers {
+    return (self.protocols.count > 0 ? RDClassMembersProtocols : 0)
+         | (self.methods.count > 0 ? RDClassMembersMethods : 0)
+         | (self.ivars.count > 0 ? RDClassMembersIvars : 0)
+         | (self.properties.count > 0 ? RDClassMembersProperties : 0);
 }
 
 - (Class)_buildClass:(nullable Class)cls error:(NSError *_Nullable *_Nullable)error {
@@ -183,11 +211,11 @@ NSInteger const RDClassBuilderInvalidNameCode = 260;
         return ECODE(RDClassBuilderInvalidArgumentCode);
     
     RDSmoke *smoke = [RDSmoke currentThreadSmoke];
-    RDClass *mirror = [smoke mirrorForObjcClass:self.superclass];
+    RDClass *mirror = [smoke mirrorForObjcClass:self.super];
     if (mirror == nil)
         return ECODE(RDClassBuilderReflectionErrorCode);
   
-    for (RDCBIvar *ivar in self.ivars) {
+    for (RDCBIvar *ivar in self.ivars.allValues) {
         RDType *type = ivar.type;
         RDTypeSize size = type.size;
         RDTypeAlign alignment = type.alignment;
@@ -195,24 +223,40 @@ NSInteger const RDClassBuilderInvalidNameCode = 260;
         class_addIvar(cls, ivar.name.UTF8String, size, alignment, encoding);
     }
 
-    for (RDCBMethod *method in self.methods) {
+    for (RDCBMethod *method in self.methods.allValues) {
         IMP imp = method.implementation ?: method.block ? imp_implementationWithBlock(method.block) : nil;
         if (imp == NULL)
             return ECODE(RDClassBuilderUnknownErrorCode);
         class_addMethod(cls, method.selector, imp, method.signature.objcTypeEncoding);
     }
 
-    for (RDCBProperty *property in self.properties) {
-        unsigned attributeCount = (unsigned)property.signature.attributesCount;
-        objc_property_attribute_t attributes[attributeCount];
-        class_addProperty(cls, property.name.UTF8String, attributes, attributeCount);
+    NSArray<NSNumber *> *kinds = RDAllPropertyAttributeKinds();
+    for (RDCBProperty *property in self.properties.allValues) {
+        RDPropertySignature *signature = property.signature;
+        const char *encoding = signature.objcTypeEncoding;
+        if (encoding == NULL || *encoding != 'T')
+            return ECODE(RDClassBuilderInvalidArgumentCode);
+
+        std::string type(encoding + 1, strcspn(encoding + 1, ","));
+        std::vector<objc_property_attribute_t> attributes { { "T", type.c_str() } };
+        char names[kinds.count][2];
+        for (NSUInteger i = 0; i < kinds.count; ++i) {
+            if ((signature.flags & (1 << i)) == 0)
+                continue;
+
+            names[i][0] = kinds[i].charValue;
+            names[i][1] = '\0';
+            RDPropertyAttribute *attribute = [signature attributeWithKind:(RDPropertyAttributeKind)names[i][0]];
+            attributes.push_back({ names[i], attribute->value.UTF8String ?: "" });
+        }
+        class_addProperty(cls, property.name.UTF8String, attributes.data(), (unsigned)attributes.size());
     }
 
-    for (RDCBProtocol *protocol in self.protocols) {
+    for (RDCBProtocol *protocol in self.protocols.allValues) {
         class_addProtocol(cls, protocol.protocol);
     }
         
-    return VALUE(Nil);
+    return VALUE(cls);
 }
 
 @end
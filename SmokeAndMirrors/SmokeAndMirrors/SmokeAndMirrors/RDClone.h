@@ -0,0 +1,29 @@
+#import <Foundation/Foundation.h>
+#import "RDCommon.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+RD_EXTERN NSErrorDomain const RDCloneErrorDomain;
+RD_EXTERN NSInteger const RDCloneUnsupportedClassErrorCode;
+RD_EXTERN NSInteger const RDCloneCopyFailedErrorCode;
+
+// Classes adopt this to have some of their object ivars copied rather than shared by RDClone
+@protocol RDDeepCloning <NSObject>
+// Ivars of the class and its superclasses; values conforming to NSMutableCopying are sent -mutableCopy,
+// other values conforming to NSCopying -copy, and the rest are cloned.
+// A value reached more than once in the same RDClone call, cycles included, is copied once.
++ (NSArray<NSString *> *)rd_deepClonedIvarNames;
+@end
+
+// Allocates an instance of the class the object reports without running -init and copies the ivars over:
+// plain bytes in bulk, strong references retained, weak references registered for the new instance.
+// Non-object pointers and object ivars the instance doesn't own are copied as is,
+// so instances owning other memory need a copy method of their own.
+// Instances with bytes allocated past their class's instance size, blocks and classes with C++ ivars that need
+// construction are not supported. Tagged pointers are returned as is. Observed objects are cloned without their
+// KVO subclass, and so without observers.
+// GNUstep can't report allocation sizes, so nothing is cloned there and RDCloneUnsupportedClassErrorCode is returned.
+// The copy plan of every class is computed from its mirror once, and again after the class is invalidated.
+RD_EXTERN id _Nullable RDClone(id _Nullable object, NSError *_Nullable *_Nullable error);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,206 @@
+#import "RDClone.h"
+#import "RDSmoke.h"
+#import "RDMirror.h"
+#import "RDPrivate.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+NSErrorDomain const RDCloneErrorDomain = @"RDCloneErrorDomain";
+NSInteger const RDCloneUnsupportedClassErrorCode = 1;
+NSInteger const RDCloneCopyFailedErrorCode = 2;
+
+#define ECODE(CODE) (void)(error != NULL && (*error = [NSError errorWithDomain:RDCloneErrorDomain code:(CODE) userInfo:nil])), nil
+
+struct RDClonePlan {
+    struct Run {
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    uint64_t generation = 0;
+    bool supported = true;
+    std::vector<Run> runs;
+    std::vector<uint32_t> strongSlots;
+    std::vector<uint32_t> weakSlots;
+    std::vector<uint32_t> deepSlots;
+};
+
+static std::shared_ptr<const RDClonePlan> RDCloneBuildPlan(RDSmoke *smoke, Class cls, uint64_t generation) {
+    auto plan = std::make_shared<RDClonePlan>();
+    plan->generation = generation;
+
+    // Concrete block classes exist under both runtimes, unlike NSBlock
+    for (void *blockClass : { (void *)_NSConcreteStackBlock, (void *)_NSConcreteMallocBlock, (void *)_NSConcreteGlobalBlock })
+        plan->supported = plan->supported && (__bridge void *)cls != blockClass;
+    if (class_getInstanceMethod(cls, sel_registerName(".cxx_construct")) != NULL)
+        plan->supported = false;
+    if (!plan->supported)
+        return plan;
+
+    NSSet<NSString *> *deepNames = [cls conformsToProtocol:@protocol(RDDeepCloning)]
+                                 ? [NSSet setWithArray:[(Class<RDDeepCloning>)cls rd_deepClonedIvarNames]]
+                                 : nil;
+
+    // Slots the instance doesn't own are left to the bulk copy, like any other pointer
+    for (Class c = cls; c != Nil; c = class_getSuperclass(c)) {
+        for (RDIvar *ivar in [smoke mirrorForObjcClass:c].ivars) {
+            RDObjectType *type = RD_CAST(ivar.type, RDObjectType);
+            if (type == nil || type.kind == RDObjectTypeKindClass || ivar.offset % sizeof(id) != 0)
+                continue;
+
+            uint32_t offset = (uint32_t)ivar.offset;
+            if (ivar.retention == RDRetentionTypeWeak)
+                plan->weakSlots.push_back(offset);
+            else if (ivar.owning)
+                ([deepNames containsObject:ivar.name] ? plan->deepSlots : plan->strongSlots).push_back(offset);
+        }
+    }
+
+    // Everything past isa is copied in bulk except the slots that have to be filled in one by one
+    std::vector<uint32_t> excluded(plan->weakSlots);
+    excluded.insert(excluded.end(), plan->deepSlots.begin(), plan->deepSlots.end());
+    std::sort(excluded.begin(), excluded.end());
+
+    uint32_t start = sizeof(Class);
+    uint32_t end = (uint32_t)class_getInstanceSize(cls);
+    for (uint32_t offset : excluded) {
+        if (offset > start)
+            plan->runs.push_back({ start, offset - start });
+        start = std::max(start, offset + (uint32_t)sizeof(id));
+    }
+    if (end > start)
+        plan->runs.push_back({ start, end - start });
+
+    return plan;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct RDCloneRegistry {
+    std::shared_mutex lock;
+    std::unordered_map<const void *, std::shared_ptr<const RDClonePlan>> plans;
+    RDSmoke *smoke = [RDSmoke new];
+};
+
+struct RDCloneCacheEntry {
+    const void *cls = nullptr;
+    std::shared_ptr<const RDClonePlan> plan;
+};
+
+static const RDClonePlan *RDClonePlanForClass(Class cls) {
+    // Leaked on purpose, so that clones made during process teardown still find it
+    static RDCloneRegistry *const registry = new RDCloneRegistry();
+    static thread_local std::array<RDCloneCacheEntry, 8> cache;
+
+    const void *key = (__bridge const void *)cls;
+    uint64_t generation = RDRuntimeGeneration();
+    RDCloneCacheEntry &entry = cache[((uintptr_t)key >> 4) % cache.size()];
+    if (entry.cls == key && entry.plan->generation == generation)
+        return entry.plan.get();
+
+    std::shared_ptr<const RDClonePlan> plan;
+    {
+        std::shared_lock<std::shared_mutex> guard(registry->lock);
+        if (auto it = registry->plans.find(key); it != registry->plans.end() && it->second->generation == generation)
+            plan = it->second;
+    }
+
+    if (plan == nullptr) {
+        std::unique_lock<std::shared_mutex> guard(registry->lock);
+        std::shared_ptr<const RDClonePlan> &stored = registry->plans[key];
+        if (stored == nullptr || stored->generation != generation)
+            stored = RDCloneBuildPlan(registry->smoke, cls, generation);
+        plan = stored;
+    }
+
+    entry.cls = key;
+    entry.plan = std::move(plan);
+    return entry.plan.get();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Originals mapped to their clones for the whole call, so that cycles and shared values through deep slots are copied once
+typedef std::unordered_map<const void *, id> RDCloneMap;
+
+static bool RDCloneIsSubclass(Class cls, Class superclass) {
+    for (Class c = cls; c != Nil; c = class_getSuperclass(c))
+        if (c == superclass)
+            return true;
+    return false;
+}
+
+static id _Nullable RDCloneObject(id _Nullable object, RDCloneMap &clones, NSError *_Nullable *_Nullable error) {
+    if (object == nil || RDIsTaggedPointer((__bridge const void *)object))
+        return object;
+    if (object_isClass(object))
+        return ECODE(RDCloneUnsupportedClassErrorCode);
+
+    // KVO swaps in a subclass that only works while observers are registered, so the clone gets the class the object reports
+    Class isa = object_getClass(object);
+    Class cls = [object class];
+    if (cls != isa && !(RDCloneIsSubclass(isa, cls) && class_getInstanceSize(isa) == class_getInstanceSize(cls)))
+        return ECODE(RDCloneUnsupportedClassErrorCode);
+
+#if __APPLE__
+    // Class clusters keep their storage past the instance size, which the plan knows nothing about
+    bool extraStorage = RDObjectAllocationSize((__bridge const void *)object) > RDGoodAllocationSize(class_getInstanceSize(cls));
+#else
+    // GNUstep can't tell how much was allocated for an instance, so storage past the instance size would go unnoticed
+    bool extraStorage = true;
+#endif
+    const RDClonePlan *plan = RDClonePlanForClass(cls);
+    if (!plan->supported || extraStorage)
+        return ECODE(RDCloneUnsupportedClassErrorCode);
+
+    id clone = class_createInstance(cls, 0);
+    clones[(__bridge const void *)object] = clone;
+    uint8_t *source = (uint8_t *)(__bridge void *)object;
+    uint8_t *destination = (uint8_t *)(__bridge void *)clone;
+
+    for (const RDClonePlan::Run &run : plan->runs)
+        memcpy(destination + run.offset, source + run.offset, run.size);
+
+    for (uint32_t offset : plan->strongSlots)
+        objc_retain((__bridge id)*(void **)(destination + offset));
+
+    for (uint32_t offset : plan->weakSlots)
+        objc_copyWeak((__autoreleasing id *)(void *)(destination + offset), (__autoreleasing id *)(void *)(source + offset));
+
+    // Slots not filled in yet are still zero, so a failing clone can be released like any other instance
+    for (uint32_t offset : plan->deepSlots) {
+        id value = (__bridge id)*(void **)(source + offset);
+        if (value == nil)
+            continue;
+
+        id copy = nil;
+        if (auto it = clones.find((__bridge const void *)value); it != clones.end())
+            copy = it->second;
+        else if (![value conformsToProtocol:@protocol(NSCopying)])
+            copy = RDCloneObject(value, clones, error);
+        // -copy of a mutable value is immutable, so values that have a mutable variant get that one
+        else if ((copy = [value conformsToProtocol:@protocol(NSMutableCopying)] ? [value mutableCopy] : [value copy]) != nil)
+            clones[(__bridge const void *)value] = copy;
+        else
+            return ECODE(RDCloneCopyFailedErrorCode);
+
+        if (copy == nil)
+            return nil;
+
+        *(void **)(destination + offset) = (__bridge_retained void *)copy;
+    }
+
+    return clone;
+}
+
+RD_EXTERN id _Nullable RDClone(id _Nullable object, NSError *_Nullable *_Nullable error) {
+    RDCloneMap clones;
+    return RDCloneObject(object, clones, error);
+}
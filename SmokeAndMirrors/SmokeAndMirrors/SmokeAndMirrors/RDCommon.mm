@@ -7,10 +7,12 @@ RD_EXTERN BOOL RDIsBlock(id object) {
     static void *blockClasses[] = {
         _NSConcreteStackBlock,
         _NSConcreteMallocBlock,
+        _NSConcreteGlobalBlock,
+#if __APPLE__
         _NSConcreteAutoBlock,
         _NSConcreteFinalizingBlock,
-        _NSConcreteGlobalBlock,
         _NSConcreteWeakBlockVariable,
+#endif
     };
     __unsafe_unretained Class cls = object_getClass(object);
 
@@ -102,5 +104,9 @@ RD_EXTERN NSUInteger RDSelectorArgumentsCount(SEL selector) {
 }
 
 RD_EXTERN long RDRetainCount(id _Nullable value) {
-    return value ? 0 : CFGetRetainCount((__bridge CFTypeRef)value);
+#if __APPLE__
+    return value == nil ? 0 : CFGetRetainCount((__bridge CFTypeRef)value);
+#else
+    return value == nil ? 0 : (long)object_getRetainCount_np(value);
+#endif
 }
@@ -0,0 +1,44 @@
+#import <Foundation/Foundation.h>
+#import "RDCommon.h"
+#import "RDType.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class RDSmoke;
+@class RDValue;
+
+typedef NS_OPTIONS(NSUInteger, RDDescriberOptions) {
+    RDDescriberOptionsNone                  = 0,
+    RDDescriberOptionsCompact               = 1 << 0,   // everything on a single line
+    RDDescriberOptionsFollowObjects         = 1 << 1,   // reflect ivars of referenced objects, not only the root one
+    RDDescriberOptionsObjectDescriptions    = 1 << 2,   // append -description of objects that aren't reflected; allocates
+};
+
+RD_FINAL_CLASS
+@interface RDDescriber : NSObject
+
+@property (nonatomic) RDDescriberOptions options;
+@property (nonatomic) NSUInteger maxDepth;
+@property (nonatomic) NSUInteger maxElements;
+@property (nonatomic, nullable) RDSmoke *smoke;
+
+@property (nonatomic, readonly) NSUInteger length;
+@property (nonatomic, readonly) const char *UTF8String;
+@property (nonatomic, readonly) int fileDescriptor;
+
+- (instancetype)init NS_DESIGNATED_INITIALIZER;
+// Output is written out whenever the buffer outgrows a chunk and at the end of every describe call
+- (instancetype)initWithFileDescriptor:(int)fileDescriptor NS_DESIGNATED_INITIALIZER;
+
+- (void)describeBytes:(const void *)bytes ofType:(RDType *)type;
+- (void)describeValue:(RDValue *)value;
+- (void)describeObject:(nullable id)object;
+- (void)appendUTF8String:(const char *)string;
+
+- (BOOL)flush;
+- (void)reset;
+- (NSString *)string;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,279 @@
+#import "RDDescriber.h"
+#import "RDPrivate.h"
+#import "RDMirror.h"
+#import "RDValue.h"
+
+#include <unistd.h>
+#include <memory>
+
+static size_t const RDDescriberChunkSize = 64 * 1024;
+static size_t const RDDescriberInlineIvarSlots = 8;
+
+RDDescriberStream::~RDDescriberStream() {
+    if (_fd >= 0)
+        flush();
+    free(_buffer);
+}
+
+void RDDescriberStream::reserve(size_t extra) {
+    if (_fd >= 0 && _length + extra > RDDescriberChunkSize)
+        flush();
+
+    if (size_t required = _length + extra + 1; required > _capacity) {
+        size_t capacity = MAX(MAX(_capacity * 2, required), (size_t)256);
+        if (char *buffer = (char *)realloc(_buffer, capacity); buffer != NULL) {
+            _buffer = buffer;
+            _capacity = capacity;
+        } else {
+            [NSException raise:NSMallocException format:@"Failed to grow describer buffer to %zu bytes", capacity];
+        }
+    }
+}
+
+void RDDescriberStream::write(const char *string, size_t length) {
+    reserve(length);
+    memcpy(_buffer + _length, string, length);
+    _length += length;
+    _buffer[_length] = '\0';
+}
+
+void RDDescriberStream::format(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    reserve(64);
+    va_list retry;
+    va_copy(retry, args);
+    int written = vsnprintf(_buffer + _length, _capacity - _length, format, args);
+    if (written >= 0 && (size_t)written >= _capacity - _length) {
+        reserve((size_t)written);
+        written = vsnprintf(_buffer + _length, _capacity - _length, format, retry);
+    }
+    va_end(retry);
+    va_end(args);
+
+    if (written > 0)
+        _length += (size_t)written;
+}
+
+void RDDescriberStream::newline() {
+    if (options & RDDescriberOptionsCompact)
+        return write(' ');
+
+    reserve(1 + _depth * 4);
+    _buffer[_length++] = '\n';
+    memset(_buffer + _length, ' ', _depth * 4);
+    _length += _depth * 4;
+    _buffer[_length] = '\0';
+}
+
+void RDDescriberStream::separator() {
+    write(';');
+    newline();
+}
+
+bool RDDescriberStream::flush() {
+    for (size_t offset = 0; _fd >= 0 && offset < _length;)
+        if (ssize_t written = ::write(_fd, _buffer + offset, _length - offset); written > 0)
+            offset += (size_t)written;
+        else if (written < 0 && errno == EINTR)
+            continue;
+        else
+            return _failed = true, reset(), false;
+
+    reset();
+    return !_failed;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void RDDescriberStream::writeBytes(const void *bytes, RDType *type) {
+    if (bytes == NULL || type == nil)
+        return write("<?>");
+
+    [type _value_streamBytes:bytes into:*this];
+}
+
+void RDDescriberStream::writeObject(__unsafe_unretained id object) {
+    if (object == nil)
+        return write("nil");
+
+    __unsafe_unretained Class cls = object_getClass(object);
+    format("(%s *)%p", class_getName(cls), (__bridge void *)object);
+
+    bool reflect = !RDIsTaggedPointer((__bridge void *)object)
+                   && (_depth == 0 || (options & RDDescriberOptionsFollowObjects));
+    if (reflect && writeReflection(object, cls))
+        return;
+
+    if (options & RDDescriberOptionsObjectDescriptions) {
+        if (const char *description = [object description].UTF8String; description != NULL)
+            format(" \"%s\"", description);
+    } else if (reflect) {
+        write(" { ... }");
+    }
+}
+
+void RDDescriberStream::writeIvars(__unsafe_unretained id object, RDClass *mirror, NSUInteger &written, NSUInteger &skipped) {
+    if (RDClass *superMirror = mirror.super; superMirror != nil)
+        writeIvars(object, superMirror, written, skipped);
+
+    for (RDIvar *ivar in mirror.ivars) {
+        if (written == maxElements) {
+            ++skipped;
+            continue;
+        }
+
+        written++ == 0 ? newline() : separator();
+        format("%s = ", ivar.name.UTF8String ?: "_");
+        // Copied out first, so that objects being mutated elsewhere are sampled as consistently as their ivar types allow.
+        // Nested descriptions reenter here, so there is no scratch buffer to share; only big ivars go to the heap
+        RDTypeSize size = ivar.type.size;
+        max_align_t stackBuffer[RDDescriberInlineIvarSlots];
+        std::unique_ptr<max_align_t[]> heapBuffer;
+        void *buffer = stackBuffer;
+        if (size != RDTypeSizeUnknown && size > sizeof(stackBuffer)) {
+            heapBuffer.reset(new max_align_t[RDAlignUp(size, sizeof(max_align_t)) / sizeof(max_align_t)]);
+            buffer = heapBuffer.get();
+        }
+
+        if (size == RDTypeSizeUnknown || size == 0 || [ivar readFromObject:object into:buffer] == RDIvarReadConsistencyUnavailable)
+            write("<?>");
+        else if (ivar.retention == RDRetentionTypeWeak)
+            writeObject(*(__unsafe_unretained id *)buffer);
+        else
+            writeBytes(buffer, ivar.type);
+    }
+}
+
+bool RDDescriberStream::writeReflection(__unsafe_unretained id object, Class cls) {
+    if (!enter())
+        return false;
+
+    if (!_visited.insert((__bridge void *)object).second) {
+        leave();
+        write(" <visited>");
+        return true;
+    }
+
+    RDSmoke *objectSmoke = smoke ?: [RDSmoke currentThreadSmoke];
+    RDClass *mirror = RDIsBlock(object) ? [objectSmoke mirrorForObjcBlock:object] : [objectSmoke mirrorForObjcClass:cls];
+
+    write(" {");
+    NSUInteger written = 0;
+    NSUInteger skipped = 0;
+    writeIvars(object, mirror, written, skipped);
+
+    if (skipped > 0) {
+        written == 0 ? newline() : separator();
+        format("... %lu more", (unsigned long)skipped);
+    }
+
+    bool empty = written == 0 && skipped == 0;
+    if (!empty)
+        write(';');
+
+    leave();
+    if (!empty)
+        newline();
+    write('}');
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@implementation RDDescriber {
+    RDDescriberStream _stream;
+}
+
+- (instancetype)init {
+    self = [super init];
+    return self;
+}
+
+- (instancetype)initWithFileDescriptor:(int)fileDescriptor {
+    self = [super init];
+    if (self) {
+        _stream.attach(fileDescriptor);
+    }
+    return self;
+}
+
+- (RDDescriberOptions)options {
+    return _stream.options;
+}
+
+- (void)setOptions:(RDDescriberOptions)options {
+    _stream.options = options;
+}
+
+- (NSUInteger)maxDepth {
+    return _stream.maxDepth;
+}
+
+- (void)setMaxDepth:(NSUInteger)maxDepth {
+    _stream.maxDepth = maxDepth;
+}
+
+- (NSUInteger)maxElements {
+    return _stream.maxElements;
+}
+
+- (void)setMaxElements:(NSUInteger)maxElements {
+    _stream.maxElements = maxElements;
+}
+
+- (RDSmoke *)smoke {
+    return _stream.smoke;
+}
+
+- (void)setSmoke:(RDSmoke *)smoke {
+    _stream.smoke = smoke;
+}
+
+- (NSUInteger)length {
+    return _stream.length();
+}
+
+- (const char *)UTF8String {
+    return _stream.string();
+}
+
+- (int)fileDescriptor {
+    return _stream.fileDescriptor();
+}
+
+- (void)describeBytes:(const void *)bytes ofType:(RDType *)type {
+    _stream.begin();
+    _stream.writeBytes(bytes, type);
+    _stream.end();
+}
+
+- (void)describeValue:(RDValue *)value {
+    RDType *type = nil;
+    const uint8_t *bytes = [value bufferType:&type];
+    [self describeBytes:bytes ofType:type];
+}
+
+- (void)describeObject:(id)object {
+    _stream.begin();
+    _stream.writeObject(object);
+    _stream.end();
+}
+
+- (void)appendUTF8String:(const char *)string {
+    _stream.write(string);
+}
+
+- (BOOL)flush {
+    return _stream.flush();
+}
+
+- (void)reset {
+    _stream.reset();
+}
+
+- (NSString *)string {
+    return @(_stream.string());
+}
+
+@end
@@ -78,6 +78,9 @@ NSInteger const RDInvocationMethodTypeSafetyErrorCode = 259;
 }
 
 - (RDValue *)invokeWithTarget:(id<NSObject>)target selector:(SEL)selector error:(NSError **)error {
+    RDMetricsIncrement(RDMetricsCounterInvocation);
+    RD_METRICS_TIME(RDMetricsTimerInvocation);
+
     if (target == nil)
         return (void)(error != NULL && (*error = nil)), nil;
     
@@ -99,7 +102,7 @@ NSInteger const RDInvocationMethodTypeSafetyErrorCode = 259;
     RD_DEFER { [RDType _ffi_type_destroy:retFFIType]; };
 
     ffi_type **argTypes = RD_FLEX_ARRAY_ELEMENT(self, ffi_type *, 0);
-    if (ffi_status status = ffi_prep_cif(&_cif, FFI_DEFAULT_ABI, (unsigned)_argCount, retFFIType, argTypes); status != FFI_OK)
+    if (ffi_status status = RDMetricsPrepCif(&_cif, (unsigned)_argCount, retFFIType, argTypes); status != FFI_OK)
         return (void)(error != NULL && (*error = RDFFIError(status))), nil;
 
     void **argValues = RD_FLEX_ARRAY_ELEMENT(self, void *, _argCount);
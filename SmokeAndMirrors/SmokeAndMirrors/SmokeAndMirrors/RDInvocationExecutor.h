@@ -0,0 +1,45 @@
+#import <Foundation/Foundation.h>
+#import "RDCommon.h"
+#import "RDType.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+// result points at the return value and is only valid for the duration of the call; it is NULL when error is set
+typedef void (^RDInvocationExecutorCompletion)(id target,
+                                               SEL selector,
+                                               void *_Nullable context,
+                                               const void *_Nullable result,
+                                               RDType *_Nullable resultType,
+                                               NSError *_Nullable error);
+
+// Invokes methods asynchronously on a pool of worker threads.
+// Calls are submitted into a fixed ring of preallocated frames that share one argument layout,
+// so submission copies the arguments inline and never allocates; completions run on the worker threads.
+RD_FINAL_CLASS
+@interface RDInvocationExecutor : NSObject
+
+@property (nonatomic, readonly) RDAggregateType *argumentsType;
+@property (nonatomic, readonly) NSUInteger capacity;
+@property (nonatomic, readonly) NSUInteger workerCount;
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+// argumentsType must be a struct whose fields are the method arguments after self and _cmd;
+// capacity is rounded up to a power of two, zero workerCount means one per active processor
+- (nullable instancetype)initWithArgumentsType:(RDAggregateType *)argumentsType
+                                      capacity:(NSUInteger)capacity
+                                   workerCount:(NSUInteger)workerCount
+                                    completion:(nullable RDInvocationExecutorCompletion)completion NS_DESIGNATED_INITIALIZER;
+
+// arguments must point at argumentsType.size bytes laid out as argumentsType; returns NO when the ring is full
+- (BOOL)trySubmitWithTarget:(id)target selector:(SEL)selector arguments:(nullable const void *)arguments context:(nullable void *)context;
+// Spins until a frame frees up
+- (void)submitWithTarget:(id)target selector:(SEL)selector arguments:(nullable const void *)arguments context:(nullable void *)context;
+
+// Blocks until every call submitted so far has completed
+- (void)waitUntilIdle;
+
+@end
+
+NS_ASSUME_NONNULL_END
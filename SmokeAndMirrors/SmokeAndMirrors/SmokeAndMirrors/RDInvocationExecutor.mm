@@ -0,0 +1,360 @@
+#import "RDInvocationExecutor.h"
+#import "RDInvocation.h"
+#import "RDMirror.h"
+#import "RDPrivate.h"
+
+#import <ffi/ffi.h>
+#import <pthread.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+static constexpr size_t RDInvocationExecutorCacheLine = 64;
+static constexpr size_t RDInvocationExecutorBatchSize = 32;
+
+struct RDInvocationFrame {
+    std::atomic<size_t> sequence;
+    void *target; // retained on submission
+    SEL selector;
+    void *context;
+};
+
+// Bounded MPMC ring after Dmitry Vyukov: every frame carries a sequence number telling producers and consumers whose turn it is
+struct RDInvocationExecutorState {
+    size_t capacity;
+    size_t stride;
+    size_t argumentsOffset;
+    uint8_t *frames;
+
+    alignas(RDInvocationExecutorCacheLine) std::atomic<size_t> enqueuePosition { 0 };
+    alignas(RDInvocationExecutorCacheLine) std::atomic<size_t> dequeuePosition { 0 };
+    alignas(RDInvocationExecutorCacheLine) std::atomic<int> sleepers { 0 };
+    std::atomic<bool> stopping { false };
+
+    dispatch_semaphore_t wakeup;
+    dispatch_group_t pending;
+    RDAggregateType *argumentsType;
+    RDInvocationExecutorCompletion completion;
+    std::vector<ffi_type *> ffiTypes; // self, _cmd and then every field of argumentsType
+    std::vector<RDOffset> offsets;
+
+    ~RDInvocationExecutorState() {
+        for (size_t i = 2; i < ffiTypes.size(); ++i)
+            [RDType _ffi_type_destroy:ffiTypes[i]];
+        free(frames);
+    }
+
+    RDInvocationFrame *frame(size_t position) const {
+        return (RDInvocationFrame *)(frames + (position & (capacity - 1)) * stride);
+    }
+
+    uint8_t *arguments(RDInvocationFrame *frame) const {
+        return (uint8_t *)frame + argumentsOffset;
+    }
+
+    RDInvocationFrame *_Nullable claim(size_t &position) {
+        position = enqueuePosition.load(std::memory_order_relaxed);
+        for (;;) {
+            RDInvocationFrame *frame = this->frame(position);
+            intptr_t diff = (intptr_t)frame->sequence.load(std::memory_order_acquire) - (intptr_t)position;
+            if (diff == 0) {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    return frame;
+            } else if (diff < 0) {
+                return nullptr;
+            } else {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    RDInvocationFrame *_Nullable take(size_t &position) {
+        position = dequeuePosition.load(std::memory_order_relaxed);
+        for (;;) {
+            RDInvocationFrame *frame = this->frame(position);
+            intptr_t diff = (intptr_t)frame->sequence.load(std::memory_order_acquire) - (intptr_t)(position + 1);
+            if (diff == 0) {
+                if (dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    return frame;
+            } else if (diff < 0) {
+                return nullptr;
+            } else {
+                position = dequeuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool empty() const {
+        size_t position = dequeuePosition.load(std::memory_order_relaxed);
+        return frame(position)->sequence.load(std::memory_order_acquire) != position + 1;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct RDInvocationCacheKey {
+    const void *cls;
+    SEL selector;
+
+    bool operator==(const RDInvocationCacheKey &other) const {
+        return cls == other.cls && selector == other.selector;
+    }
+};
+
+struct RDInvocationCacheKeyHash {
+    size_t operator()(const RDInvocationCacheKey &key) const {
+        return std::hash<const void *>()(key.cls) ^ (std::hash<const void *>()((const void *)key.selector) << 1);
+    }
+};
+
+// Method is cached rather than its IMP, so swizzling via method_setImplementation is picked up on the next call
+struct RDInvocationCacheEntry {
+    Method method = NULL;
+    ffi_cif cif;
+    ffi_type *returnFFIType = NULL;
+    RDType *returnType = nil;
+    NSInteger errorCode = 0;
+
+    RDInvocationCacheEntry() = default;
+    RDInvocationCacheEntry(const RDInvocationCacheEntry &) = delete;
+    ~RDInvocationCacheEntry() {
+        if (returnFFIType != NULL)
+            [RDType _ffi_type_destroy:returnFFIType];
+    }
+};
+
+// Owned by a single worker thread, so neither lookups nor flushes need to synchronize
+class RDInvocationCache {
+public:
+    RDInvocationCacheEntry &lookup(RDInvocationExecutorState &state, Class cls, SEL selector) {
+        auto [it, inserted] = _entries.try_emplace({ (__bridge const void *)cls, selector });
+        if (inserted)
+            prepare(state, it->second, cls, selector);
+        return it->second;
+    }
+
+    void revalidate() {
+        if (uint64_t generation = RDRuntimeGeneration(); generation != _generation) {
+            _entries.clear();
+            _generation = generation;
+        }
+    }
+
+private:
+    std::unordered_map<RDInvocationCacheKey, RDInvocationCacheEntry, RDInvocationCacheKeyHash> _entries;
+    uint64_t _generation = 0;
+
+    static void prepare(RDInvocationExecutorState &state, RDInvocationCacheEntry &entry, Class cls, SEL selector) {
+        Method method = class_getInstanceMethod(cls, selector);
+        if (method == NULL)
+            return (void)(entry.errorCode = RDInvocationMethodResolutionErrorCode);
+
+        RDMethodSignature *signature = [RDMethodSignature signatureWithObjcTypeEncoding:method_getTypeEncoding(method)];
+        if (signature == nil || signature.argumentsCount != state.ffiTypes.size() || signature.returnValue->type == nil)
+            return (void)(entry.errorCode = RDInvocationMethodTypeSafetyErrorCode);
+
+        for (NSUInteger i = 2; i < signature.argumentsCount; ++i)
+            if (RDMethodArgument *argument = [signature argumentAtIndex:i]; argument == NULL
+                || ![argument->type isAssignableFromType:[state.argumentsType fieldAtIndex:i - 2]->type])
+                return (void)(entry.errorCode = RDInvocationMethodTypeSafetyErrorCode);
+
+        entry.returnType = signature.returnValue->type;
+        entry.returnFFIType = entry.returnType._ffi_type;
+        if (entry.returnFFIType == NULL)
+            return (void)(entry.errorCode = RDInvocationMethodTypeSafetyErrorCode);
+
+        if (RDMetricsPrepCif(&entry.cif, (unsigned)state.ffiTypes.size(), entry.returnFFIType, state.ffiTypes.data()) != FFI_OK)
+            return (void)(entry.errorCode = RDInvocationFFIErrorCode);
+
+        entry.method = method;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void RDInvocationExecutorRun(RDInvocationExecutorState &state,
+                                    RDInvocationCache &cache,
+                                    std::vector<void *> &values,
+                                    std::vector<max_align_t> &result,
+                                    RDInvocationFrame *frame)
+{
+    RDMetricsIncrement(RDMetricsCounterInvocation);
+    RD_METRICS_TIME(RDMetricsTimerInvocation);
+
+    __unsafe_unretained id target = (__bridge id)frame->target;
+    uint8_t *arguments = state.arguments(frame);
+    RDInvocationCacheEntry &entry = cache.lookup(state, object_getClass(target), frame->selector);
+
+    if (entry.method == NULL) {
+        if (state.completion != nil)
+            state.completion(target, frame->selector, frame->context, NULL, nil,
+                             [NSError errorWithDomain:RDInvocationErrorDomain code:entry.errorCode userInfo:nil]);
+    } else {
+        size_t resultSize = MAX(entry.returnType.size, sizeof(ffi_arg));
+        if (result.size() * sizeof(max_align_t) < resultSize)
+            result.resize((resultSize + sizeof(max_align_t) - 1) / sizeof(max_align_t));
+
+        values[0] = &frame->target;
+        values[1] = &frame->selector;
+        for (size_t i = 0; i < state.offsets.size(); ++i)
+            values[i + 2] = arguments + state.offsets[i];
+
+        ffi_call(&entry.cif, method_getImplementation(entry.method), result.data(), values.data());
+        if (state.completion != nil)
+            state.completion(target, frame->selector, frame->context, result.data(), entry.returnType, nil);
+    }
+
+    [state.argumentsType _value_releaseBytes:arguments];
+    objc_release(target);
+}
+
+static void RDInvocationExecutorWorker(std::shared_ptr<RDInvocationExecutorState> statePointer) {
+#if __APPLE__
+    pthread_setname_np("RDInvocationExecutor");
+#else
+    pthread_setname_np(pthread_self(), "RDInvocationExecutor");
+#endif
+
+    RDInvocationExecutorState &state = *statePointer;
+    RDInvocationCache cache;
+    std::vector<void *> values(state.ffiTypes.size());
+    std::vector<max_align_t> result(1);
+
+    for (;;) {
+        size_t drained = 0;
+        @autoreleasepool {
+            cache.revalidate();
+            size_t position;
+            for (; drained < RDInvocationExecutorBatchSize; ++drained) {
+                RDInvocationFrame *frame = state.take(position);
+                if (frame == nullptr)
+                    break;
+
+                RDInvocationExecutorRun(state, cache, values, result, frame);
+                frame->sequence.store(position + state.capacity, std::memory_order_release);
+                dispatch_group_leave(state.pending);
+            }
+        }
+
+        if (drained > 0)
+            continue;
+        if (state.stopping.load(std::memory_order_acquire))
+            break;
+
+        // Announce sleeping before the final emptiness check, pairs with the fence in -trySubmit...
+        state.sleepers.fetch_add(1, std::memory_order_seq_cst);
+        if (state.empty())
+            dispatch_semaphore_wait(state.wakeup, DISPATCH_TIME_FOREVER);
+        state.sleepers.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@implementation RDInvocationExecutor {
+    std::shared_ptr<RDInvocationExecutorState> _state;
+    std::vector<std::thread> _workers;
+}
+
+- (instancetype)initWithArgumentsType:(RDAggregateType *)argumentsType
+                             capacity:(NSUInteger)capacity
+                          workerCount:(NSUInteger)workerCount
+                           completion:(RDInvocationExecutorCompletion)completion
+{
+    if (argumentsType == nil || argumentsType.kind != RDAggregateTypeKindStruct)
+        return nil;
+
+    auto state = std::make_shared<RDInvocationExecutorState>();
+    state->ffiTypes = { &ffi_type_pointer, &ffi_type_pointer };
+    for (NSUInteger i = 0; i < argumentsType.count; ++i) {
+        RDField *field = [argumentsType fieldAtIndex:i];
+        ffi_type *type = field == NULL || field->offset == RDOffsetUnknown ? NULL : field->type._ffi_type;
+        if (type == NULL)
+            return nil;
+
+        state->ffiTypes.push_back(type);
+        state->offsets.push_back(field->offset);
+    }
+
+    state->capacity = 1;
+    while (state->capacity < MAX(capacity, 2u))
+        state->capacity <<= 1;
+    state->argumentsOffset = RDAlignUp(sizeof(RDInvocationFrame), alignof(max_align_t));
+    state->stride = RDAlignUp(state->argumentsOffset + argumentsType.size, RDInvocationExecutorCacheLine);
+    state->frames = (uint8_t *)aligned_alloc(RDInvocationExecutorCacheLine, state->stride * state->capacity);
+    if (state->frames == NULL)
+        return nil;
+    for (size_t i = 0; i < state->capacity; ++i)
+        new (state->frame(i)) RDInvocationFrame { { i }, NULL, NULL, NULL };
+
+    state->wakeup = dispatch_semaphore_create(0);
+    state->pending = dispatch_group_create();
+    state->argumentsType = argumentsType;
+    state->completion = [completion copy];
+
+    self = [super init];
+    if (self) {
+        _argumentsType = argumentsType;
+        _capacity = state->capacity;
+        _workerCount = workerCount > 0 ? workerCount : NSProcessInfo.processInfo.activeProcessorCount;
+        _state = state;
+        for (NSUInteger i = 0; i < _workerCount; ++i)
+            _workers.emplace_back(RDInvocationExecutorWorker, state);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    _state->stopping.store(true, std::memory_order_release);
+    for (NSUInteger i = 0; i < _workers.size(); ++i)
+        dispatch_semaphore_signal(_state->wakeup);
+
+    // The last reference may go away inside a completion, and a worker cannot join itself
+    for (std::thread &worker : _workers)
+        if (worker.get_id() == std::this_thread::get_id())
+            worker.detach();
+        else
+            worker.join();
+}
+
+- (BOOL)trySubmitWithTarget:(id)target selector:(SEL)selector arguments:(const void *)arguments context:(void *)context {
+    NSParameterAssert(target);
+    NSParameterAssert(selector);
+
+    RDInvocationExecutorState &state = *_state;
+    size_t position;
+    RDInvocationFrame *frame = state.claim(position);
+    if (frame == nullptr)
+        return NO;
+
+    dispatch_group_enter(state.pending);
+    frame->target = (__bridge void *)objc_retain(target);
+    frame->selector = selector;
+    frame->context = context;
+    if (uint8_t *frameArguments = state.arguments(frame); arguments != NULL) {
+        memcpy(frameArguments, arguments, _argumentsType.size);
+        [_argumentsType _value_retainBytes:frameArguments];
+    } else {
+        memset(frameArguments, 0, _argumentsType.size);
+    }
+    frame->sequence.store(position + 1, std::memory_order_release);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (state.sleepers.load(std::memory_order_relaxed) > 0)
+        dispatch_semaphore_signal(state.wakeup);
+    return YES;
+}
+
+- (void)submitWithTarget:(id)target selector:(SEL)selector arguments:(const void *)arguments context:(void *)context {
+    while (![self trySubmitWithTarget:target selector:selector arguments:arguments context:context])
+        sched_yield();
+}
+
+- (void)waitUntilIdle {
+    dispatch_group_wait(_state->pending, DISPATCH_TIME_FOREVER);
+}
+
+@end
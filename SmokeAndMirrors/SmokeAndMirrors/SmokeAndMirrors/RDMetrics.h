@@ -0,0 +1,73 @@
+#import <Foundation/Foundation.h>
+#import "RDCommon.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(NSUInteger, RDMetricsCounter) {
+    RDMetricsCounterTypeParseSucceeded,
+    RDMetricsCounterTypeParseFailed,
+    RDMetricsCounterSmokeCacheHit,
+    RDMetricsCounterSmokeCacheMiss,
+    RDMetricsCounterClassMirrorConstruction,
+    RDMetricsCounterProtocolMirrorConstruction,
+    RDMetricsCounterMethodMirrorConstruction,
+    RDMetricsCounterPropertyMirrorConstruction,
+    RDMetricsCounterIvarMirrorConstruction,
+    RDMetricsCounterBlockMirrorConstruction,
+    RDMetricsCounterClassMirrorRefresh,
+    RDMetricsCounterFFIPrepCif,
+    RDMetricsCounterInvocation,
+};
+
+static NSUInteger const RDMetricsCounterCount = RDMetricsCounterInvocation + 1;
+
+typedef NS_ENUM(NSUInteger, RDMetricsTimer) {
+    RDMetricsTimerTypeParse,
+    RDMetricsTimerMirrorConstruction,
+    RDMetricsTimerFFIPrepCif,
+    RDMetricsTimerInvocation,
+};
+
+static NSUInteger const RDMetricsTimerCount = RDMetricsTimerInvocation + 1;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static NSUInteger const RDMetricsHistogramBucketCount = 32;
+
+// Bucket i counts samples that took [2^i, 2^(i+1)) nanoseconds; the last bucket is open-ended
+typedef struct {
+    uint64_t count;
+    uint64_t totalNanoseconds;
+    uint64_t buckets[RDMetricsHistogramBucketCount];
+} RDMetricsHistogram;
+
+RD_FINAL_CLASS
+@interface RDMetricsSnapshot : NSObject
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+- (uint64_t)valueForCounter:(RDMetricsCounter)counter;
+- (RDMetricsHistogram)histogramForTimer:(RDMetricsTimer)timer;
+
+- (RDMetricsSnapshot *)snapshotBySubtractingSnapshot:(RDMetricsSnapshot *)snapshot;
+- (NSDictionary<NSString *, id> *)dictionaryRepresentation;
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef void (^RDMetricsParseFailureSink)(const char *encoding, const char *failurePosition);
+
+RD_EXTERN RDMetricsSnapshot *RDMetricsTakeSnapshot(void);
+
+RD_EXTERN BOOL RDMetricsIsTimingEnabled(void);
+RD_EXTERN void RDMetricsSetTimingEnabled(BOOL enabled);
+
+// Replaces rate-limited NSLog reporting of type encoding parse failures; pass nil to restore it
+RD_EXTERN void RDMetricsSetParseFailureSink(RDMetricsParseFailureSink _Nullable sink);
+
+RD_EXTERN NSString *RDMetricsCounterName(RDMetricsCounter counter);
+RD_EXTERN NSString *RDMetricsTimerName(RDMetricsTimer timer);
+
+NS_ASSUME_NONNULL_END
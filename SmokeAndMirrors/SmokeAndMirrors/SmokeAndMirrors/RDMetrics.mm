@@ -0,0 +1,244 @@
+#import "RDMetrics.h"
+#import "RDPrivate.h"
+
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
+std::atomic<bool> RDMetricsTimingEnabled(false);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct RDMetricsTotals {
+    uint64_t counters[RDMetricsCounterCount];
+    RDMetricsHistogram timers[RDMetricsTimerCount];
+};
+
+struct RDMetricsRegistry {
+    std::mutex lock;
+    std::vector<RDMetricsThreadStorage *> live;
+    RDMetricsTotals retired;
+};
+
+static RDMetricsRegistry &RDMetricsSharedRegistry(void) {
+    // Leaked on purpose: thread-local storages of late threads unregister after static destructors have run
+    static RDMetricsRegistry *registry = new RDMetricsRegistry();
+    return *registry;
+}
+
+static void RDMetricsAccumulate(const RDMetricsThreadStorage &storage, RDMetricsTotals &totals) {
+    for (NSUInteger i = 0; i < RDMetricsCounterCount; ++i)
+        totals.counters[i] += storage.counters[i].load(std::memory_order_relaxed);
+
+    for (NSUInteger i = 0; i < RDMetricsTimerCount; ++i) {
+        totals.timers[i].count += storage.timerCounts[i].load(std::memory_order_relaxed);
+        totals.timers[i].totalNanoseconds += storage.timerTotals[i].load(std::memory_order_relaxed);
+        for (NSUInteger j = 0; j < RDMetricsHistogramBucketCount; ++j)
+            totals.timers[i].buckets[j] += storage.timerBuckets[i][j].load(std::memory_order_relaxed);
+    }
+}
+
+RDMetricsThreadStorage::RDMetricsThreadStorage() {
+    for (auto &counter : counters)
+        counter.store(0, std::memory_order_relaxed);
+    for (NSUInteger i = 0; i < RDMetricsTimerCount; ++i) {
+        timerCounts[i].store(0, std::memory_order_relaxed);
+        timerTotals[i].store(0, std::memory_order_relaxed);
+        for (auto &bucket : timerBuckets[i])
+            bucket.store(0, std::memory_order_relaxed);
+    }
+
+    RDMetricsRegistry &registry = RDMetricsSharedRegistry();
+    std::lock_guard<std::mutex> guard(registry.lock);
+    registry.live.push_back(this);
+}
+
+RDMetricsThreadStorage::~RDMetricsThreadStorage() {
+    RDMetricsRegistry &registry = RDMetricsSharedRegistry();
+    std::lock_guard<std::mutex> guard(registry.lock);
+    RDMetricsAccumulate(*this, registry.retired);
+    registry.live.erase(std::remove(registry.live.begin(), registry.live.end(), this), registry.live.end());
+}
+
+RDMetricsThreadStorage &RDMetricsCurrentThreadStorage(void) {
+    static thread_local RDMetricsThreadStorage storage;
+    return storage;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static std::mutex RDMetricsSinkLock;
+static RDMetricsParseFailureSink RDMetricsSink = nil;
+
+void RDMetricsReportParseFailure(const char *encoding, const char *failurePosition) {
+    RDMetricsParseFailureSink sink = nil;
+    {
+        std::lock_guard<std::mutex> guard(RDMetricsSinkLock);
+        sink = RDMetricsSink;
+    }
+
+    if (sink != nil)
+        return sink(encoding, failurePosition);
+
+    static std::atomic<int64_t> lastReportTime(INT64_MIN);
+    static std::atomic<uint64_t> suppressedCount(0);
+
+    int64_t now = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t last = lastReportTime.load(std::memory_order_relaxed);
+    if (now <= last || !lastReportTime.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+        suppressedCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    if (uint64_t suppressed = suppressedCount.exchange(0, std::memory_order_relaxed); suppressed > 0)
+        NSLog(@"Failed to parse type encoding \"%s\" at \"%s\" (%llu more failures suppressed)", encoding, failurePosition, suppressed);
+    else
+        NSLog(@"Failed to parse type encoding \"%s\" at \"%s\"", encoding, failurePosition);
+}
+
+RD_EXTERN void RDMetricsSetParseFailureSink(RDMetricsParseFailureSink _Nullable sink) {
+    std::lock_guard<std::mutex> guard(RDMetricsSinkLock);
+    RDMetricsSink = [sink copy];
+}
+
+RD_EXTERN BOOL RDMetricsIsTimingEnabled(void) {
+    return RDMetricsTimingEnabled.load(std::memory_order_relaxed);
+}
+
+RD_EXTERN void RDMetricsSetTimingEnabled(BOOL enabled) {
+    RDMetricsTimingEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@implementation RDMetricsSnapshot {
+    RDMetricsTotals _totals;
+}
+
+- (instancetype)initWithTotals:(const RDMetricsTotals &)totals {
+    self = [super init];
+    if (self) {
+        _totals = totals;
+    }
+    return self;
+}
+
+- (uint64_t)valueForCounter:(RDMetricsCounter)counter {
+    return counter < RDMetricsCounterCount ? _totals.counters[counter] : 0;
+}
+
+- (RDMetricsHistogram)histogramForTimer:(RDMetricsTimer)timer {
+    return timer < RDMetricsTimerCount ? _totals.timers[timer] : (RDMetricsHistogram){};
+}
+
+- (RDMetricsSnapshot *)snapshotBySubtractingSnapshot:(RDMetricsSnapshot *)snapshot {
+    RDMetricsTotals totals = _totals;
+    for (NSUInteger i = 0; i < RDMetricsCounterCount; ++i)
+        totals.counters[i] -= MIN(totals.counters[i], snapshot->_totals.counters[i]);
+
+    for (NSUInteger i = 0; i < RDMetricsTimerCount; ++i) {
+        RDMetricsHistogram &lhs = totals.timers[i];
+        const RDMetricsHistogram &rhs = snapshot->_totals.timers[i];
+        lhs.count -= MIN(lhs.count, rhs.count);
+        lhs.totalNanoseconds -= MIN(lhs.totalNanoseconds, rhs.totalNanoseconds);
+        for (NSUInteger j = 0; j < RDMetricsHistogramBucketCount; ++j)
+            lhs.buckets[j] -= MIN(lhs.buckets[j], rhs.buckets[j]);
+    }
+
+    return [[RDMetricsSnapshot alloc] initWithTotals:totals];
+}
+
+- (NSDictionary<NSString *, id> *)dictionaryRepresentation {
+    NSMutableDictionary<NSString *, NSNumber *> *counters = [NSMutableDictionary dictionary];
+    for (NSUInteger i = 0; i < RDMetricsCounterCount; ++i)
+        counters[RDMetricsCounterName((RDMetricsCounter)i)] = @(_totals.counters[i]);
+
+    NSMutableDictionary<NSString *, NSDictionary *> *timers = [NSMutableDictionary dictionary];
+    for (NSUInteger i = 0; i < RDMetricsTimerCount; ++i) {
+        const RDMetricsHistogram &histogram = _totals.timers[i];
+        NSMutableArray<NSNumber *> *buckets = [NSMutableArray arrayWithCapacity:RDMetricsHistogramBucketCount];
+        for (NSUInteger j = 0; j < RDMetricsHistogramBucketCount; ++j)
+            [buckets addObject:@(histogram.buckets[j])];
+
+        timers[RDMetricsTimerName((RDMetricsTimer)i)] = @{
+            @"count": @(histogram.count),
+            @"totalNanoseconds": @(histogram.totalNanoseconds),
+            @"log2Buckets": buckets,
+        };
+    }
+
+    return @{ @"counters": counters, @"timers": timers };
+}
+
+- (NSString *)description {
+    NSMutableString *result = [NSMutableString stringWithFormat:@"<%@: %p>", self.class, self];
+    for (NSUInteger i = 0; i < RDMetricsCounterCount; ++i)
+        [result appendFormat:@"\n    %@ = %llu", RDMetricsCounterName((RDMetricsCounter)i), _totals.counters[i]];
+    for (NSUInteger i = 0; i < RDMetricsTimerCount; ++i)
+        if (const RDMetricsHistogram &histogram = _totals.timers[i]; histogram.count > 0)
+            [result appendFormat:@"\n    %@ = %llu samples, %.1fns avg", RDMetricsTimerName((RDMetricsTimer)i),
+             histogram.count, (double)histogram.totalNanoseconds / histogram.count];
+    return result;
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+RD_EXTERN RDMetricsSnapshot *RDMetricsTakeSnapshot(void) {
+    RDMetricsTotals totals = {};
+    RDMetricsRegistry &registry = RDMetricsSharedRegistry();
+    {
+        std::lock_guard<std::mutex> guard(registry.lock);
+        totals = registry.retired;
+        for (RDMetricsThreadStorage *storage : registry.live)
+            RDMetricsAccumulate(*storage, totals);
+    }
+    return [[RDMetricsSnapshot alloc] initWithTotals:totals];
+}
+
+RD_EXTERN NSString *RDMetricsCounterName(RDMetricsCounter counter) {
+    switch (counter) {
+        case RDMetricsCounterTypeParseSucceeded:
+            return @"typeParseSucceeded";
+        case RDMetricsCounterTypeParseFailed:
+            return @"typeParseFailed";
+        case RDMetricsCounterSmokeCacheHit:
+            return @"smokeCacheHit";
+        case RDMetricsCounterSmokeCacheMiss:
+            return @"smokeCacheMiss";
+        case RDMetricsCounterClassMirrorConstruction:
+            return @"classMirrorConstruction";
+        case RDMetricsCounterProtocolMirrorConstruction:
+            return @"protocolMirrorConstruction";
+        case RDMetricsCounterMethodMirrorConstruction:
+            return @"methodMirrorConstruction";
+        case RDMetricsCounterPropertyMirrorConstruction:
+            return @"propertyMirrorConstruction";
+        case RDMetricsCounterIvarMirrorConstruction:
+            return @"ivarMirrorConstruction";
+        case RDMetricsCounterBlockMirrorConstruction:
+            return @"blockMirrorConstruction";
+        case RDMetricsCounterClassMirrorRefresh:
+            return @"classMirrorRefresh";
+        case RDMetricsCounterFFIPrepCif:
+            return @"ffiPrepCif";
+        case RDMetricsCounterInvocation:
+            return @"invocation";
+    }
+    return @"unknown";
+}
+
+RD_EXTERN NSString *RDMetricsTimerName(RDMetricsTimer timer) {
+    switch (timer) {
+        case RDMetricsTimerTypeParse:
+            return @"typeParse";
+        case RDMetricsTimerMirrorConstruction:
+            return @"mirrorConstruction";
+        case RDMetricsTimerFFIPrepCif:
+            return @"ffiPrepCif";
+        case RDMetricsTimerInvocation:
+            return @"invocation";
+    }
+    return @"unknown";
+}
@@ -18,8 +18,30 @@ typedef struct objc_method_description MethodDescription;
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+typedef NS_OPTIONS(NSUInteger, RDClassMembers) {
+    RDClassMembersProtocols     = 1 << 0,
+    RDClassMembersProperties    = 1 << 1,
+    RDClassMembersMethods       = 1 << 2,
+    RDClassMembersIvars         = 1 << 3,
+    RDClassMembersAll           = RDClassMembersProtocols | RDClassMembersProperties | RDClassMembersMethods | RDClassMembersIvars,
+};
+
+// Bumped on every invalidation; anything caching runtime state can compare it to decide whether to revalidate
+RD_EXTERN uint64_t RDRuntimeGeneration(void);
+
+// Marks member lists of cls as stale in every mirror; class-level members live on the metaclass
+RD_EXTERN void RDInvalidateClass(Class cls, RDClassMembers members);
+RD_EXTERN void RDInvalidateAllClasses(RDClassMembers members);
+// Use instead of objc_disposeClassPair, so caches keyed by class let go of cls and a class later allocated at its address starts afresh:
+// smokes build a new mirror for it rather than handing out the old one
+RD_EXTERN void RDDisposeClass(Class cls);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 @interface RDMirror : NSObject
-@property (nonatomic, readonly) RDSmoke *smoke;
+// Smokes that retain their mirrors are not kept alive by them, so this turns nil once such a smoke is gone;
+// the mirror keeps working, looking up the mirrors it builds from then on in +[RDSmoke currentThreadSmoke]
+@property (nonatomic, readonly, nullable) RDSmoke *smoke;
 
 + (instancetype)new NS_UNAVAILABLE;
 - (instancetype)init NS_UNAVAILABLE;
@@ -28,6 +50,7 @@ typedef struct objc_method_description MethodDescription;
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// Member lists are rebuilt on the first read after the class is invalidated; reading them from several threads is safe
 @interface RDClass : RDMirror
 
 @property (nonatomic, readonly, nullable) RDClass *super;
@@ -43,6 +66,8 @@ typedef struct objc_method_description MethodDescription;
 @property (nonatomic, readonly) NSArray<RDIvar *> *ivars;
 @property (nonatomic, readonly) size_t instanceSize;
 
+@property (nonatomic, readonly) uint64_t generation;
+
 @end
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -113,12 +138,51 @@ typedef NS_ENUM(NSUInteger, RDRetentionType) {
     RDRetentionTypeWeak,
 };
 
+typedef NS_ENUM(NSUInteger, RDIvarReadConsistency) {
+    // Nothing was read: the ivar has no known offset or type
+    RDIvarReadConsistencyUnavailable,
+    // Plain copy that may tear if the ivar is written concurrently
+    RDIvarReadConsistencyNone,
+    // Single lock-free load
+    RDIvarReadConsistencyAtomic,
+    // objc_loadWeak; the object is returned autoreleased
+    RDIvarReadConsistencyWeak,
+    // Copy validated by the class's RDSequence, see RDSequencedIvars
+    RDIvarReadConsistencySequenced,
+};
+
+// Seqlock counter; writers bracket updates with RDSequenceBeginWrite/RDSequenceEndWrite, one writer at a time
+typedef struct {
+    uintptr_t value;
+} RDSequence;
+
+static inline void RDSequenceBeginWrite(RDSequence *sequence) {
+    __atomic_store_n(&sequence->value, sequence->value + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void RDSequenceEndWrite(RDSequence *sequence) {
+    __atomic_store_n(&sequence->value, sequence->value + 1, __ATOMIC_RELEASE);
+}
+
+// Classes adopt this to get consistent reads of ivars that don't fit a single atomic load;
+// it covers the ivars declared by the adopting class and its subclasses
+@protocol RDSequencedIvars <NSObject>
+// Offset of the RDSequence ivar guarding the instance's multi-word ivars
++ (ptrdiff_t)rd_ivarSequenceOffset;
+@end
+
 @interface RDIvar : RDMirror
 
 @property (nonatomic, readonly, nullable) NSString *name;
 @property (nonatomic, readonly) ptrdiff_t offset;
 @property (nonatomic, readonly, nullable) RDType *type;
 @property (nonatomic, readonly) RDRetentionType retention;
+// Holds a reference the instance owns: strong, or unretained in a class compiled without ARC
+@property (nonatomic, readonly) BOOL owning;
+
+// Copies type.size bytes of the ivar into buffer using the strongest access its type allows, without taking locks
+- (RDIvarReadConsistency)readFromObject:(id)object into:(void *)buffer;
 
 @end
 
@@ -2,28 +2,177 @@
 #import "RDMirrorPrivate.h"
 #import "RDSmoke.h"
 #import "RDPrivate.h"
+#if __APPLE__
+#import <mach-o/dyld.h>
+#import <dlfcn.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 NSString *methodString(SEL selector, RDMethodSignature *signature, BOOL isInstanceLevel);
 NSString *blockString(NSString *name, RDMethodSignature *signature);
 NSString *propertyString(NSString *name, RDPropertySignature *signature, BOOL isInstanceLevel);
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static constexpr size_t RDClassMembersCount = 4;
+using RDClassMembersStamps = std::array<uint64_t, RDClassMembersCount>;
+
+// Generation at which each member list of a class was last invalidated, and at which each class address was last disposed;
+// never shrinks, so leaked on purpose
+struct RDInvalidationRegistry {
+    std::atomic<uint64_t> generation { 1 };
+    std::atomic<uint64_t> lastDisposal { 0 };
+    std::mutex lock;
+    std::unordered_map<const void *, RDClassMembersStamps> classes;
+    std::unordered_map<const void *, uint64_t> disposals;
+    RDClassMembersStamps all {};
+};
+
+static RDInvalidationRegistry &RDInvalidations() {
+    static RDInvalidationRegistry *registry = new RDInvalidationRegistry();
+    return *registry;
+}
+
+static void RDStampClassMembers(RDClassMembersStamps &stamps, RDClassMembers members, uint64_t generation) {
+    for (size_t i = 0; i < RDClassMembersCount; ++i)
+        if (members & (1 << i))
+            stamps[i] = generation;
+}
+
+RD_EXTERN uint64_t RDRuntimeGeneration(void) {
+    return RDInvalidations().generation.load(std::memory_order_acquire);
+}
+
+RD_EXTERN void RDInvalidateClass(Class cls, RDClassMembers members) {
+    if (cls == Nil || (members & RDClassMembersAll) == 0)
+        return;
+
+    RDInvalidationRegistry &registry = RDInvalidations();
+    std::lock_guard<std::mutex> guard(registry.lock);
+    uint64_t generation = registry.generation.load(std::memory_order_relaxed) + 1;
+    RDStampClassMembers(registry.classes[(__bridge const void *)cls], members, generation);
+    registry.generation.store(generation, std::memory_order_release);
+}
+
+RD_EXTERN void RDInvalidateAllClasses(RDClassMembers members) {
+    if ((members & RDClassMembersAll) == 0)
+        return;
+
+    RDInvalidationRegistry &registry = RDInvalidations();
+    std::lock_guard<std::mutex> guard(registry.lock);
+    uint64_t generation = registry.generation.load(std::memory_order_relaxed) + 1;
+    RDStampClassMembers(registry.all, members, generation);
+    registry.generation.store(generation, std::memory_order_release);
+}
+
+RD_EXTERN void RDDisposeClass(Class cls) {
+    if (cls == Nil)
+        return;
+
+    const void *keys[] = { (__bridge const void *)cls, (__bridge const void *)object_getClass(cls) };
+    objc_disposeClassPair(cls);
+
+    // Recorded after the fact, so that nothing mirrored before the disposal passes for current
+    RDInvalidationRegistry &registry = RDInvalidations();
+    std::lock_guard<std::mutex> guard(registry.lock);
+    uint64_t generation = registry.generation.load(std::memory_order_relaxed) + 1;
+    for (const void *key : keys) {
+        RDStampClassMembers(registry.classes[key], RDClassMembersAll, generation);
+        registry.disposals[key] = generation;
+    }
+    registry.lastDisposal.store(generation, std::memory_order_release);
+    registry.generation.store(generation, std::memory_order_release);
+}
+
+RD_EXTERN uint64_t RDLastClassDisposal(void) {
+    return RDInvalidations().lastDisposal.load(std::memory_order_acquire);
+}
+
+RD_EXTERN BOOL RDClassDisposedSince(const void *cls, uint64_t generation) {
+    RDInvalidationRegistry &registry = RDInvalidations();
+    if (registry.lastDisposal.load(std::memory_order_acquire) <= generation)
+        return NO;
+
+    std::lock_guard<std::mutex> guard(registry.lock);
+    auto it = registry.disposals.find(cls);
+    return it != registry.disposals.end() && it->second > generation;
+}
+
+static RDClassMembers RDStaleClassMembers(Class cls, uint64_t since) {
+    RDInvalidationRegistry &registry = RDInvalidations();
+    std::lock_guard<std::mutex> guard(registry.lock);
+    auto it = registry.classes.find((__bridge const void *)cls);
+    RDClassMembers stale = 0;
+    for (size_t i = 0; i < RDClassMembersCount; ++i)
+        if (std::max(registry.all[i], it == registry.classes.end() ? 0 : it->second[i]) > since)
+            stale |= 1 << i;
+    return stale;
+}
+
+#if __APPLE__
+// objc4 flags classes compiled with ARC; without that SPI nothing is known, and unretained ivars are taken as not owned
+static BOOL RDClassUsesManualRetainRelease(Class cls) {
+    static BOOL (*usesAutomaticRetainRelease)(Class) = (BOOL (*)(Class))dlsym(RTLD_DEFAULT, "_class_usesAutomaticRetainRelease");
+    return usesAutomaticRetainRelease != NULL && !usesAutomaticRetainRelease(cls);
+}
+
+// Images loaded later may bring categories onto classes that are already mirrored.
+// libobjc2 has no such hook; call RDInvalidateAllClasses after loading code there.
+static void RDImageAdded(const struct mach_header *, intptr_t) {
+    RDInvalidateAllClasses(RDClassMembersAll);
+}
+
+__attribute__((constructor))
+static void RDRegisterImageObserver(void) {
+    _dyld_register_func_for_add_image(RDImageAdded);
+}
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 @interface RDMirror()
 - (instancetype)initWithSmoke:(RDSmoke *)smoke NS_DESIGNATED_INITIALIZER;
+// Where mirrors of members and relatives are looked up; one that outlived its smoke uses the current thread's
+@property (nonatomic, readonly) RDSmoke *lookupSmoke;
 @end
 
-@implementation RDMirror
+@implementation RDMirror {
+    RDSmoke *_retainingSmoke;
+    __weak RDSmoke *_owningSmoke;
+}
 
 - (instancetype)initWithSmoke:(RDSmoke *)smoke {
     self = [super init];
     if (self) {
-        _smoke = smoke;
+        // A smoke that holds its mirrors strongly would otherwise never be freed along with them
+        if (smoke.retentionPolicy == RDSmokeRetentionPolicyWeak)
+            _retainingSmoke = smoke;
+        else
+            _owningSmoke = smoke;
     }
     return self;
 }
+
+- (RDSmoke *)smoke {
+    return _retainingSmoke ?: _owningSmoke;
+}
+
+- (RDSmoke *)lookupSmoke {
+    return self.smoke ?: RDSmoke.currentThreadSmoke;
+}
+
+- (size_t)_estimatedSize {
+    return RDObjectAllocationSize((__bridge const void *)self);
+}
+
 @end
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -51,9 +200,22 @@ NSString *propertyString(NSString *name, RDPropertySignature *signature, BOOL is
 
 @end
 
-@implementation RDClass
-@synthesize super = _super;
-@synthesize meta = _meta;
+// Member lists as of one runtime generation; replaced as a whole, so readers on other threads never see them half rebuilt
+struct RDClassMembersSnapshot {
+    uint64_t generation;
+    NSArray<RDProtocol *> *protocols;
+    NSArray<RDMethod *> *methods;
+    NSArray<RDIvar *> *ivars;
+    NSArray<RDProperty *> *properties;
+};
+
+@implementation RDClass {
+    std::shared_ptr<const RDClassMembersSnapshot> _members;
+    // Serializes rebuilds of _members and the lazy lookups of super and meta
+    std::mutex _lock;
+    RDClass *_super;
+    RDClass *_meta;
+}
 
 - (instancetype)initWithObjcClass:(Class)cls
                           inSmoke:(RDSmoke *)smoke
@@ -77,12 +239,14 @@ NSString *propertyString(NSString *name, RDPropertySignature *signature, BOOL is
         _version = version;
         _instanceSize = instanceSize;
         _imageName = image.copy;
-        _protocols = protocols.copy;
-        _methods = methods.copy;
-        _ivars = ivars.copy;
-        _properties = properties.copy;
-        _objcSuper = class_getSuperclass(cls);
-        _objcMeta = object_getClass(cls);
+        _builtGeneration = RDRuntimeGeneration();
+        _members = std::make_shared<const RDClassMembersSnapshot>(RDClassMembersSnapshot {
+            .generation = _builtGeneration,
+            .protocols = protocols.copy,
+            .methods = methods.copy,
+            .ivars = ivars.copy,
+            .properties = properties.copy,
+        });
     }
     return self;
 }
@@ -93,6 +257,7 @@ NSString *propertyString(NSString *name, RDPropertySignature *signature, BOOL is
     
     self = [super initWithSmoke:smoke];
     if (self) {
+        _builtGeneration = RDRuntimeGeneration();
         _objcClass = cls;
         _objcSuper = class_getSuperclass(cls);
         _objcMeta = object_getClass(cls);
@@ -102,91 +267,204 @@ NSString *propertyString(NSString *name, RDPropertySignature *signature, BOOL is
             name == NULL ? nil : [NSString stringWithUTF8String:class_getName(cls)];
         });
 
+#if __APPLE__
        _imageName = ({
             const char *imageName = class_getImageName(cls);
             imageName == NULL ? nil : [NSString stringWithUTF8String:imageName];
         });
+#endif
 
         _version = class_getVersion(cls);
 
         _instanceSize = class_getInstanceSize(cls);
-        
-        _protocols = ({
-            unsigned count;
-            Protocol *__unsafe_unretained *protocolList = class_copyProtocolList(cls, &count);
-            RDProtocol *protocols[count];
-            for (unsigned i = 0; i < count; ++i)
-                protocols[i] = [smoke mirrorForObjcProtocol:protocolList[i]];
-            free(protocolList);
-            [NSArray arrayWithObjects:protocols count:count];
-        });
 
-        _methods = ({
-            unsigned count;
-            Method *methodList = class_copyMethodList(cls, &count);
-            RDMethod *methods[count];
-            for (unsigned i = 0; i < count; ++i)
-                methods[i] = [smoke mirrorForObjcMethod:methodList[i]];
-            free(methodList);
-            [NSArray arrayWithObjects:methods count:count];
-        });
-
-        _ivars = ^{
-            unsigned int count;
-            Ivar *ivarList = class_copyIvarList(cls, &count);
-            if (count == 0)
-                return (void)free(ivarList), @[];
-            
-            RDIvar *ivars[count];
-            for (unsigned i = 0; i < count; ++i)
-                ivars[i] = [smoke mirrorForObjcIvar:ivarList[i]];
-            free(ivarList);
-                        
-            auto layoutIndices = ^NSIndexSet *(const uint8_t *layout, size_t istart) {
-                NSUInteger startIndex = istart / sizeof(id);
-                if (istart % sizeof(id) != 0 || layout == NULL)
-                    return nil;
-                
-                NSMutableIndexSet *indices = [NSMutableIndexSet indexSet];
-                while (*layout != '\0') {
-                    startIndex += (*layout & 0xf0) >> 4;
-                    size_t len = *layout & 0x0f;
-                    [indices addIndexesInRange:NSMakeRange(startIndex, len)];
-                    startIndex += len;
-                    ++layout;
-                }
-                return indices;
-            };
-            
-            size_t istart = ivars[0].offset;
-            const uint8_t *strongLayout = class_getIvarLayout(cls);
-            NSIndexSet *istrong = layoutIndices(strongLayout, istart);
-            const uint8_t *weakLayout = class_getWeakIvarLayout(cls);
-            NSIndexSet *iweak = layoutIndices(weakLayout, istart);
-            const size_t ss = sizeof(id); // slot size
-            
-            for (unsigned i = 0; i < count; ++i)
-                if (ptrdiff_t offset = ivars[i].offset; offset % ss == 0)
-                    ivars[i].retention = [iweak containsIndex:offset / ss] ? RDRetentionTypeWeak
-                                       : [istrong containsIndex:offset / ss] ? RDRetentionTypeStrong
-                                       : RDRetentionTypeUnsafeUnretained;
-            
-            return [NSArray arrayWithObjects:ivars count:count];
-        }();
-        
-        _properties = ({
-            unsigned int count;
-            Property *propertyList = class_copyPropertyList(cls, &count);
-            RDProperty *properties[count];
-            for (unsigned i = 0; i < count; ++i)
-                properties[i] = [smoke mirrorForObjcProperty:propertyList[i]];
-            free(propertyList);
-            [NSArray arrayWithObjects:properties count:count];
+        _members = std::make_shared<const RDClassMembersSnapshot>(RDClassMembersSnapshot {
+            .generation = _builtGeneration,
+            .protocols = [self _buildProtocols],
+            .methods = [self _buildMethods],
+            .ivars = [self _buildIvars],
+            .properties = [self _buildProperties],
         });
     }
     return self;
 }
 
+- (NSArray<RDProtocol *> *)_buildProtocols {
+    unsigned count;
+    Protocol *__unsafe_unretained *protocolList = class_copyProtocolList(self.objcClass, &count);
+    RDProtocol *protocols[count];
+    for (unsigned i = 0; i < count; ++i)
+        protocols[i] = [self.lookupSmoke mirrorForObjcProtocol:protocolList[i]];
+    free(protocolList);
+    return [NSArray arrayWithObjects:protocols count:count];
+}
+
+- (NSArray<RDMethod *> *)_buildMethods {
+    unsigned count;
+    Method *methodList = class_copyMethodList(self.objcClass, &count);
+    RDMethod *methods[count];
+    for (unsigned i = 0; i < count; ++i)
+        methods[i] = [self.lookupSmoke mirrorForObjcMethod:methodList[i]];
+    free(methodList);
+    return [NSArray arrayWithObjects:methods count:count];
+}
+
+- (NSArray<RDIvar *> *)_buildIvars {
+    __unsafe_unretained Class cls = self.objcClass;
+    unsigned int count;
+    Ivar *ivarList = class_copyIvarList(cls, &count);
+    if (count == 0)
+        return (void)free(ivarList), @[];
+
+    // Ivars belong to the class that declares them, so whether a seqlock guards them is settled here once.
+    // Conformance is read from the runtime rather than asked, so that mirroring a class doesn't run its +initialize.
+    ptrdiff_t sequenceOffset = RDOffsetUnknown;
+    for (Class c = cls; c != Nil; c = class_getSuperclass(c))
+        if (class_conformsToProtocol(c, @protocol(RDSequencedIvars))) {
+            sequenceOffset = [(Class<RDSequencedIvars>)cls rd_ivarSequenceOffset];
+            break;
+        }
+
+    RDIvar *ivars[count];
+    RDRetentionType retention[count];
+    for (unsigned i = 0; i < count; ++i) {
+        ivars[i] = [self.lookupSmoke mirrorForObjcIvar:ivarList[i]];
+        retention[i] = RDRetentionTypeUnsafeUnretained;
+    }
+
+    bool manual[count];
+#if !__APPLE__
+    // libobjc2 records ownership on each ivar rather than in layout strings; code built without ARC records none
+    for (unsigned i = 0; i < count; ++i) {
+        objc_ivar_ownership ownership = ivar_getOwnership(ivarList[i]);
+        retention[i] = ownership == ownership_strong ? RDRetentionTypeStrong
+                           : ownership == ownership_weak ? RDRetentionTypeWeak
+                           : RDRetentionTypeUnsafeUnretained;
+        manual[i] = ownership == ownership_invalid;
+    }
+    free(ivarList);
+#else
+    free(ivarList);
+
+    auto layoutIndices = ^NSIndexSet *(const uint8_t *layout, size_t istart) {
+        NSUInteger startIndex = istart / sizeof(id);
+        if (istart % sizeof(id) != 0 || layout == NULL)
+            return nil;
+
+        NSMutableIndexSet *indices = [NSMutableIndexSet indexSet];
+        while (*layout != '\0') {
+            startIndex += (*layout & 0xf0) >> 4;
+            size_t len = *layout & 0x0f;
+            [indices addIndexesInRange:NSMakeRange(startIndex, len)];
+            startIndex += len;
+            ++layout;
+        }
+        return indices;
+    };
+
+    size_t istart = ivars[0].offset;
+    const uint8_t *strongLayout = class_getIvarLayout(cls);
+    NSIndexSet *istrong = layoutIndices(strongLayout, istart);
+    const uint8_t *weakLayout = class_getWeakIvarLayout(cls);
+    NSIndexSet *iweak = layoutIndices(weakLayout, istart);
+    const size_t ss = sizeof(id); // slot size
+
+    for (unsigned i = 0; i < count; ++i)
+        if (ptrdiff_t offset = ivars[i].offset; offset % ss == 0)
+            retention[i] = [iweak containsIndex:offset / ss] ? RDRetentionTypeWeak
+                         : [istrong containsIndex:offset / ss] ? RDRetentionTypeStrong
+                         : RDRetentionTypeUnsafeUnretained;
+
+    std::fill(manual, manual + count, RDClassUsesManualRetainRelease(cls));
+#endif
+
+    // Object ivars of classes built without ARC are owned by convention, whatever their declared retention
+    for (unsigned i = 0; i < count; ++i) {
+        BOOL owning = [ivars[i].type isKindOfClass:RDObjectType.self]
+                   && (retention[i] == RDRetentionTypeStrong || (manual[i] && retention[i] == RDRetentionTypeUnsafeUnretained));
+        [ivars[i] _setRetention:retention[i] owning:owning sequenceOffset:sequenceOffset];
+    }
+
+    return [NSArray arrayWithObjects:ivars count:count];
+}
+
+- (NSArray<RDProperty *> *)_buildProperties {
+    unsigned int count;
+    Property *propertyList = class_copyPropertyList(self.objcClass, &count);
+    RDProperty *properties[count];
+    for (unsigned i = 0; i < count; ++i)
+        properties[i] = [self.lookupSmoke mirrorForObjcProperty:propertyList[i]];
+    free(propertyList);
+    return [NSArray arrayWithObjects:properties count:count];
+}
+
+// Readers keep the snapshot they loaded alive for as long as they use it, so a concurrent rebuild never frees it under them
+- (std::shared_ptr<const RDClassMembersSnapshot>)_currentMembers {
+    uint64_t generation = RDRuntimeGeneration();
+    std::shared_ptr<const RDClassMembersSnapshot> members = std::atomic_load(&_members);
+    if (members->generation == generation)
+        return members;
+
+    std::lock_guard<std::mutex> guard(_lock);
+    members = std::atomic_load(&_members);
+    if (members->generation == generation)
+        return members;
+
+    // The new generation is published together with the lists rebuilt for it, never ahead of them
+    auto updated = std::make_shared<RDClassMembersSnapshot>(*members);
+    updated->generation = generation;
+    if (RDClassMembers stale = RDStaleClassMembers(self.objcClass, members->generation); stale != 0) {
+        RDMetricsIncrement(RDMetricsCounterClassMirrorRefresh);
+        [self.lookupSmoke _buildMembers:^{
+            if (stale & RDClassMembersProtocols)
+                updated->protocols = [self _buildProtocols];
+            if (stale & RDClassMembersMethods)
+                updated->methods = [self _buildMethods];
+            if (stale & RDClassMembersIvars)
+                updated->ivars = [self _buildIvars];
+            if (stale & RDClassMembersProperties)
+                updated->properties = [self _buildProperties];
+        }];
+    }
+
+    members = std::move(updated);
+    std::atomic_store(&_members, members);
+    return members;
+}
+
+- (NSArray<RDProtocol *> *)protocols {
+    return [self _currentMembers]->protocols;
+}
+
+- (NSArray<RDMethod *> *)methods {
+    return [self _currentMembers]->methods;
+}
+
+- (NSArray<RDIvar *> *)ivars {
+    return [self _currentMembers]->ivars;
+}
+
+- (NSArray<RDProperty *> *)properties {
+    return [self _currentMembers]->properties;
+}
+
+- (uint64_t)generation {
+    return [self _currentMembers]->generation;
+}
+
+- (size_t)_estimatedSize {
+    // Methods, ivars and properties belong to this class alone and live as long as it does, so they are counted with it;
+    // protocols are shared between classes, so only the references to them are
+    std::shared_ptr<const RDClassMembersSnapshot> members = std::atomic_load(&_members);
+    size_t size = [super _estimatedSize]
+                + (members->protocols.count + members->methods.count + members->ivars.count + members->properties.count) * sizeof(id)
+                + _name.length + _imageName.length;
+    for (NSArray<RDMirror *> *list in @[ members->methods, members->ivars, members->properties ])
+        for (RDMirror *member in list)
+            size += [member _estimatedSize];
+    return size;
+}
+
 - (NSString *)description {
     NSString *protocols = self.protocols.count == 0 ? @"" : ({
         NSString *comps = [[self.protocols valueForKeyPath:@"@unionOfObjects.name"] componentsJoinedByString:@", "];
@@ -216,20 +494,21 @@ NSString *propertyString(NSString *name, RDPropertySignature *signature, BOOL is
 }
 
 - (RDClass *)super {
+    std::lock_guard<std::mutex> guard(_lock);
     if (_super == nil && self.objcSuper != Nil)
-        _super = [self.smoke mirrorForObjcClass:self.objcSuper];
+        _super = [self.lookupSmoke mirrorForObjcClass:self.objcSuper];
 
     return _super;
 }
 
 - (RDClass *)meta {
-    if (_meta == nil) {
-        if (self.objcMeta == Nil || self.objcMeta == self.objcClass)
-            return self;
-        else
-            _meta = [self.smoke mirrorForObjcClass:self.objcMeta];
-    }
-    
+    if (self.objcMeta == Nil || self.objcMeta == self.objcClass)
+        return self;
+
+    std::lock_guard<std::mutex> guard(_lock);
+    if (_meta == nil)
+        _meta = [self.lookupSmoke mirrorForObjcClass:self.objcMeta];
+
     return _meta;
 }
 
@@ -379,6 +658,12 @@ NSString *propertyString(NSString *name, RDPropertySignature *signature, BOOL is
     return self;
 }
 
+- (size_t)_estimatedSize {
+    return [super _estimatedSize]
+         + (self.protocols.count + self.methods.count + self.properties.count) * sizeof(id)
+         + self.name.length;
+}
+
 - (NSString *)description {
     auto requiredFilter = ^__kindof RDProtocolItem *(__kindof RDProtocolItem *i) { return i.isRequired ? i : nil; };
     auto optionalFilter = ^__kindof RDProtocolItem *(__kindof RDProtocolItem *i) { return i.isRequired ? nil : i; };
@@ -481,11 +766,64 @@ NSString *propertyString(NSString *name, RDPropertySignature *signature, BOOL is
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+typedef NS_ENUM(uint8_t, RDIvarAccess) {
+    RDIvarAccessUnresolved,
+    RDIvarAccessUnavailable,
+    RDIvarAccessPlain,
+    RDIvarAccessAtomic,
+    RDIvarAccessWeak,
+    RDIvarAccessSequenced,
+};
+
+static RDIvarAccess RDIvarAccessForType(RDType *type, RDRetentionType retention, ptrdiff_t offset, ptrdiff_t sequenceOffset) {
+    if (type == nil || offset == RDOffsetUnknown || type.size == RDTypeSizeUnknown || type.size == 0)
+        return RDIvarAccessUnavailable;
+    if (retention == RDRetentionTypeWeak && [type isKindOfClass:RDObjectType.self])
+        return RDIvarAccessWeak;
+    if ([type isKindOfClass:RDBitfieldType.self])
+        return RDIvarAccessPlain;
+
+    // Anything of a lock-free power-of-two size that is naturally aligned is read in one load, _Atomic or not
+    size_t size = type.size;
+    bool lockFree = (size == 1 || size == 2 || size == 4 || size == 8 || size == 16) && __atomic_is_lock_free(size, NULL);
+    if (lockFree && offset % size == 0)
+        return RDIvarAccessAtomic;
+    return sequenceOffset == RDOffsetUnknown ? RDIvarAccessPlain : RDIvarAccessSequenced;
+}
+
+static bool RDIvarReadAtomic(const uint8_t *bytes, void *buffer, size_t size) {
+    switch (size) {
+        case 1: return *(uint8_t *)buffer = __atomic_load_n((const uint8_t *)bytes, __ATOMIC_ACQUIRE), true;
+        case 2: return *(uint16_t *)buffer = __atomic_load_n((const uint16_t *)bytes, __ATOMIC_ACQUIRE), true;
+        case 4: return *(uint32_t *)buffer = __atomic_load_n((const uint32_t *)bytes, __ATOMIC_ACQUIRE), true;
+        case 8: return *(uint64_t *)buffer = __atomic_load_n((const uint64_t *)bytes, __ATOMIC_ACQUIRE), true;
+        case 16: return __atomic_load((const __uint128_t *)bytes, (__uint128_t *)buffer, __ATOMIC_ACQUIRE), true;
+        default: return false;
+    }
+}
+
+static bool RDIvarReadSequenced(const RDSequence *sequence, const uint8_t *bytes, void *buffer, size_t size) {
+    static const NSUInteger maxAttempts = 1024;
+    for (NSUInteger attempt = 0; attempt < maxAttempts; ++attempt) {
+        uintptr_t before = __atomic_load_n(&sequence->value, __ATOMIC_ACQUIRE);
+        if (before & 1)
+            continue;
+
+        memcpy(buffer, bytes, size);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&sequence->value, __ATOMIC_RELAXED) == before)
+            return true;
+    }
+    return false;
+}
+
 @interface RDIvar()
 @property (nonatomic, readonly) Ivar ivar;
 @end
 
-@implementation RDIvar
+@implementation RDIvar {
+    std::atomic<RDIvarAccess> _access;
+}
 
 - (instancetype)initWithObjcIvar:(Ivar)ivar inSmoke:(RDSmoke *)smoke {
     self = [super initWithSmoke:smoke];
@@ -493,6 +831,7 @@ NSString *propertyString(NSString *name, RDPropertySignature *signature, BOOL is
         _ivar = ivar;
         
         _offset = ivar_getOffset(ivar);
+        _sequenceOffset = RDOffsetUnknown;
         
         _name = ({
             const char *name = ivar_getName(ivar);
@@ -509,6 +848,45 @@ NSString *propertyString(NSString *name, RDPropertySignature *signature, BOOL is
     return self;
 }
 
+- (void)_setRetention:(RDRetentionType)retention owning:(BOOL)owning sequenceOffset:(ptrdiff_t)sequenceOffset {
+    _retention = retention;
+    _owning = owning;
+    _sequenceOffset = sequenceOffset;
+    // Reads before the declaring class was mirrored settled on a plan without these, so it is replaced along with them
+    _access.store(RDIvarAccessForType(self.type, retention, self.offset, sequenceOffset), std::memory_order_release);
+}
+
+- (RDIvarReadConsistency)readFromObject:(id)object into:(void *)buffer {
+    RDIvarAccess access = _access.load(std::memory_order_acquire);
+    if (access == RDIvarAccessUnresolved)
+        _access.store(access = RDIvarAccessForType(self.type, self.retention, self.offset, self.sequenceOffset), std::memory_order_relaxed);
+
+    if (object == nil || buffer == NULL || access == RDIvarAccessUnavailable)
+        return RDIvarReadConsistencyUnavailable;
+
+    const uint8_t *bytes = (const uint8_t *)(__bridge void *)object + self.offset;
+    size_t size = self.type.size;
+    switch (access) {
+        case RDIvarAccessWeak:
+            *(void **)buffer = (__bridge void *)objc_loadWeak((__autoreleasing id *)(void *)bytes);
+            return RDIvarReadConsistencyWeak;
+
+        case RDIvarAccessAtomic:
+            RDIvarReadAtomic(bytes, buffer, size);
+            return RDIvarReadConsistencyAtomic;
+
+        case RDIvarAccessSequenced:
+            if (RDIvarReadSequenced((const RDSequence *)((const uint8_t *)(__bridge void *)object + self.sequenceOffset), bytes, buffer, size))
+                return RDIvarReadConsistencySequenced;
+            memcpy(buffer, bytes, size);
+            return RDIvarReadConsistencyNone;
+
+        default:
+            memcpy(buffer, bytes, size);
+            return RDIvarReadConsistencyNone;
+    }
+}
+
 - (NSString *)description {
     NSString *retention = ^{
         if ([self.type isKindOfClass:RDObjectType.self])
@@ -1,12 +1,39 @@
 #import "RDMirror.h"
+#import "RDSmoke.h"
 #import "RDPrivate.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
+// Generation of the latest RDDisposeClass, 0 if there was none; lets caches keyed by class address skip the lookup below
+RD_EXTERN uint64_t RDLastClassDisposal(void);
+// Whether the class at this address was disposed after the given generation
+RD_EXTERN BOOL RDClassDisposedSince(const void *cls, uint64_t generation);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@interface RDSmoke (RDMirrorPrivate)
+
+// Mirrors looked up inside block are taken as built along with another one: not counted as requests, not retained
+- (void)_buildMembers:(NS_NOESCAPE void (^)(void))block;
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@interface RDMirror()
+
+// Rough heap footprint, used by RDSmoke to enforce its byte budget
+- (size_t)_estimatedSize;
+
+@end
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 @interface RDClass()
 
+// Runtime generation the mirror was built at; a smoke drops it once its class has been disposed since
+@property (nonatomic, readonly) uint64_t builtGeneration;
+
 - (instancetype)initWithSmoke:(RDSmoke *)smoke NS_UNAVAILABLE;
 - (instancetype)initWithObjcClass:(__unsafe_unretained Class)cls inSmoke:(RDSmoke *)smoke NS_DESIGNATED_INITIALIZER;
 
@@ -55,7 +82,11 @@ NS_ASSUME_NONNULL_BEGIN
 
 @interface RDIvar()
 
-@property (nonatomic, readwrite) RDRetentionType retention;
+// RDOffsetUnknown unless the declaring class adopts RDSequencedIvars
+@property (nonatomic, readonly) ptrdiff_t sequenceOffset;
+
+// Set by the declaring class's mirror, which is the only one that can tell; the read plan is recomputed from them
+- (void)_setRetention:(RDRetentionType)retention owning:(BOOL)owning sequenceOffset:(ptrdiff_t)sequenceOffset;
 
 - (instancetype)initWithSmoke:(RDSmoke *)smoke NS_UNAVAILABLE;
 - (instancetype)initWithObjcIvar:(Ivar)ivar inSmoke:(RDSmoke *)smoke NS_DESIGNATED_INITIALIZER;
@@ -0,0 +1,54 @@
+#import <Foundation/Foundation.h>
+#import "RDCommon.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+RD_FINAL_CLASS
+@interface RDObjectGraphClassStatistics : NSObject
+
+@property (nonatomic, readonly, unsafe_unretained) Class objcClass;
+@property (nonatomic, readonly) NSUInteger instanceCount;
+@property (nonatomic, readonly) size_t shallowSize;
+// Memory only reachable through instances of the class; instances dominated by another instance of it are not counted twice
+@property (nonatomic, readonly) size_t retainedSize;
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+RD_FINAL_CLASS
+@interface RDObjectGraphReport : NSObject
+
+@property (nonatomic, readonly) NSUInteger objectCount;
+@property (nonatomic, readonly) size_t totalSize;
+// Sorted by retainedSize, largest first
+@property (nonatomic, readonly) NSArray<RDObjectGraphClassStatistics *> *classStatistics;
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+// Memory freed if only the root at index went away
+- (size_t)retainedSizeOfRootAtIndex:(NSUInteger)index;
+
+@end
+
+// Follows strong ivars (and, optionally, Foundation collection contents) from a set of roots.
+// Shallow sizes are malloc sizes, so trailing buffers allocated with the instance are included.
+// The graph must not be mutated while it is analyzed.
+RD_FINAL_CLASS
+@interface RDObjectGraphAnalyzer : NSObject
+
+// Follow the contents of NSArray, NSSet, NSOrderedSet and NSDictionary instances; YES by default
+@property (nonatomic) BOOL followsCollections;
+@property (nonatomic, readonly) NSUInteger concurrency;
+
+// Zero concurrency means one per active processor
+- (instancetype)init;
+- (instancetype)initWithConcurrency:(NSUInteger)concurrency NS_DESIGNATED_INITIALIZER;
+
+- (RDObjectGraphReport *)analyzeRoots:(NSArray *)roots;
+
+@end
+
+NS_ASSUME_NONNULL_END
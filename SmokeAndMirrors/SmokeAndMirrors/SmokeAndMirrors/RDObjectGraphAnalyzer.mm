@@ -0,0 +1,457 @@
+#import "RDObjectGraphAnalyzer.h"
+#import "RDSmoke.h"
+#import "RDMirror.h"
+#import "RDPrivate.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+typedef NS_ENUM(uint8_t, RDObjectGraphContainer) {
+    RDObjectGraphContainerNone,
+    RDObjectGraphContainerArray,
+    RDObjectGraphContainerSet,
+    RDObjectGraphContainerOrderedSet,
+    RDObjectGraphContainerDictionary,
+};
+
+// Bit i is set when the pointer-sized word i of an instance holds a strong object reference
+struct RDObjectGraphClassPlan {
+    std::vector<uint64_t> strongSlots;
+    RDObjectGraphContainer container = RDObjectGraphContainerNone;
+};
+
+static RDObjectGraphContainer RDObjectGraphContainerForClass(Class cls) {
+    static const std::pair<Class, RDObjectGraphContainer> containers[] = {
+        { NSArray.self, RDObjectGraphContainerArray },
+        { NSSet.self, RDObjectGraphContainerSet },
+        { NSOrderedSet.self, RDObjectGraphContainerOrderedSet },
+        { NSDictionary.self, RDObjectGraphContainerDictionary },
+    };
+
+    for (Class c = cls; c != Nil; c = class_getSuperclass(c))
+        for (auto &[containerClass, container] : containers)
+            if (c == containerClass)
+                return container;
+    return RDObjectGraphContainerNone;
+}
+
+static std::unique_ptr<RDObjectGraphClassPlan> RDObjectGraphBuildPlan(RDSmoke *smoke, Class cls) {
+    auto plan = std::make_unique<RDObjectGraphClassPlan>();
+    plan->strongSlots.resize(RDAlignUp(class_getInstanceSize(cls), sizeof(id) * 64) / (sizeof(id) * 64));
+    plan->container = RDObjectGraphContainerForClass(cls);
+
+    for (Class c = cls; c != Nil; c = class_getSuperclass(c))
+        for (RDIvar *ivar in [smoke mirrorForObjcClass:c].ivars) {
+            RDObjectType *type = RD_CAST(ivar.type, RDObjectType);
+            if (!ivar.owning || type.kind == RDObjectTypeKindClass || ivar.offset % sizeof(id) != 0)
+                continue;
+
+            size_t slot = ivar.offset / sizeof(id);
+            if (slot / 64 < plan->strongSlots.size())
+                plan->strongSlots[slot / 64] |= 1ull << (slot % 64);
+        }
+    return plan;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Maps every discovered object to a dense node index; node 0 is reserved for the virtual root
+class RDObjectGraphVisitedSet {
+public:
+    std::pair<uint32_t, bool> insert(const void *object) {
+        Shard &shard = _shards[((uintptr_t)object >> 4) * 0x9E3779B97F4A7C15ull >> (64 - ShardBits)];
+        std::lock_guard<std::mutex> guard(shard.lock);
+        auto [it, inserted] = shard.indices.try_emplace(object, 0);
+        if (inserted)
+            it->second = _count.fetch_add(1, std::memory_order_relaxed);
+        return { it->second, inserted };
+    }
+
+    uint32_t count() const {
+        return _count.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr unsigned ShardBits = 6;
+
+    struct alignas(64) Shard {
+        std::mutex lock;
+        std::unordered_map<const void *, uint32_t> indices;
+    };
+
+    std::array<Shard, 1 << ShardBits> _shards;
+    std::atomic<uint32_t> _count { 1 };
+};
+
+struct RDObjectGraphNode {
+    uint32_t index;
+    const void *object;
+};
+
+struct RDObjectGraphChunk {
+    std::vector<RDObjectGraphNode> discovered;
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    std::vector<std::pair<uint32_t, size_t>> sizes;
+    std::vector<std::pair<uint32_t, const void *>> classes;
+    std::unordered_map<const void *, const RDObjectGraphClassPlan *> plans;
+};
+
+// Adjacency in compressed sparse row form
+struct RDObjectGraphAdjacency {
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> targets;
+
+    RDObjectGraphAdjacency(size_t count, const std::vector<std::pair<uint32_t, uint32_t>> &edges, bool reversed)
+        : offsets(count + 1, 0), targets(edges.size())
+    {
+        for (auto &[from, to] : edges)
+            ++offsets[(reversed ? to : from) + 1];
+        for (size_t i = 0; i < count; ++i)
+            offsets[i + 1] += offsets[i];
+
+        std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (auto &[from, to] : edges)
+            targets[cursor[reversed ? to : from]++] = reversed ? from : to;
+    }
+
+    template<typename F>
+    void forEach(uint32_t node, F &&body) const {
+        for (uint32_t i = offsets[node]; i < offsets[node + 1]; ++i)
+            body(targets[i]);
+    }
+};
+
+// Cooper, Harvey, Kennedy: "A Simple, Fast Dominance Algorithm"
+static std::vector<uint32_t> RDObjectGraphDominators(size_t count, const RDObjectGraphAdjacency &successors,
+                                                     const RDObjectGraphAdjacency &predecessors, std::vector<uint32_t> &order)
+{
+    constexpr uint32_t undefined = UINT32_MAX;
+    std::vector<uint32_t> postorder(count, undefined);
+    order.clear();
+    order.reserve(count);
+
+    std::vector<std::pair<uint32_t, uint32_t>> stack { { 0, successors.offsets[0] } };
+    postorder[0] = 0;
+    while (!stack.empty()) {
+        auto &[node, next] = stack.back();
+        if (next < successors.offsets[node + 1]) {
+            uint32_t child = successors.targets[next++];
+            if (postorder[child] == undefined) {
+                postorder[child] = 0;
+                stack.push_back({ child, successors.offsets[child] });
+            }
+        } else {
+            postorder[node] = (uint32_t)order.size();
+            order.push_back(node);
+            stack.pop_back();
+        }
+    }
+    std::reverse(order.begin(), order.end());
+
+    std::vector<uint32_t> idom(count, undefined);
+    idom[0] = 0;
+    auto intersect = [&](uint32_t a, uint32_t b) {
+        while (a != b) {
+            while (postorder[a] < postorder[b])
+                a = idom[a];
+            while (postorder[b] < postorder[a])
+                b = idom[b];
+        }
+        return a;
+    };
+
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (uint32_t node : order) {
+            if (node == 0)
+                continue;
+
+            uint32_t dominator = undefined;
+            predecessors.forEach(node, [&](uint32_t predecessor) {
+                if (idom[predecessor] != undefined)
+                    dominator = dominator == undefined ? predecessor : intersect(predecessor, dominator);
+            });
+            if (idom[node] != dominator) {
+                idom[node] = dominator;
+                changed = true;
+            }
+        }
+    }
+    return idom;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@implementation RDObjectGraphClassStatistics
+
+- (instancetype)initWithClass:(Class)cls count:(NSUInteger)count shallowSize:(size_t)shallowSize retainedSize:(size_t)retainedSize {
+    self = [super init];
+    if (self) {
+        _objcClass = cls;
+        _instanceCount = count;
+        _shallowSize = shallowSize;
+        _retainedSize = retainedSize;
+    }
+    return self;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"%@: %lu instances, %zu bytes, %zu retained",
+            NSStringFromClass(self.objcClass), (unsigned long)self.instanceCount, self.shallowSize, self.retainedSize];
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@implementation RDObjectGraphReport {
+    std::vector<size_t> _rootRetainedSizes;
+}
+
+- (instancetype)initWithObjectCount:(NSUInteger)objectCount
+                          totalSize:(size_t)totalSize
+                    classStatistics:(NSArray<RDObjectGraphClassStatistics *> *)classStatistics
+                 rootRetainedSizes:(std::vector<size_t>)rootRetainedSizes
+{
+    self = [super init];
+    if (self) {
+        _objectCount = objectCount;
+        _totalSize = totalSize;
+        _classStatistics = classStatistics;
+        _rootRetainedSizes = std::move(rootRetainedSizes);
+    }
+    return self;
+}
+
+- (size_t)retainedSizeOfRootAtIndex:(NSUInteger)index {
+    return index < _rootRetainedSizes.size() ? _rootRetainedSizes[index] : 0;
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@implementation RDObjectGraphAnalyzer {
+    RDSmoke *_smoke;
+    std::shared_mutex _plansLock;
+    std::unordered_map<const void *, std::unique_ptr<RDObjectGraphClassPlan>> _plans;
+}
+
+- (instancetype)init {
+    return [self initWithConcurrency:0];
+}
+
+- (instancetype)initWithConcurrency:(NSUInteger)concurrency {
+    self = [super init];
+    if (self) {
+        _concurrency = concurrency > 0 ? concurrency : NSProcessInfo.processInfo.activeProcessorCount;
+        _followsCollections = YES;
+        _smoke = [RDSmoke new];
+    }
+    return self;
+}
+
+// Plans never go stale: the ivars of a realized class cannot change
+- (const RDObjectGraphClassPlan *)_planForClass:(Class)cls {
+    const void *key = (__bridge const void *)cls;
+    {
+        std::shared_lock<std::shared_mutex> guard(_plansLock);
+        if (auto it = _plans.find(key); it != _plans.end())
+            return it->second.get();
+    }
+
+    std::unique_lock<std::shared_mutex> guard(_plansLock);
+    auto [it, inserted] = _plans.try_emplace(key, nullptr);
+    if (inserted)
+        it->second = RDObjectGraphBuildPlan(_smoke, cls);
+    return it->second.get();
+}
+
+static void RDObjectGraphVisit(RDObjectGraphVisitedSet &visited, RDObjectGraphChunk &chunk, uint32_t from, const void *child) {
+    if (child == NULL || RDIsTaggedPointer(child) || object_isClass((__bridge id)child))
+        return;
+
+    auto [index, inserted] = visited.insert(child);
+    chunk.edges.push_back({ from, index });
+    if (inserted)
+        chunk.discovered.push_back({ index, child });
+}
+
+static void RDObjectGraphScan(RDObjectGraphAnalyzer *analyzer, RDObjectGraphNode node, RDObjectGraphVisitedSet &visited,
+                              RDObjectGraphChunk &chunk, BOOL followsCollections)
+{
+    __unsafe_unretained id object = (__bridge id)node.object;
+    Class cls = object_getClass(object);
+    const void *key = (__bridge const void *)cls;
+
+    auto [it, inserted] = chunk.plans.try_emplace(key, nullptr);
+    if (inserted)
+        it->second = [analyzer _planForClass:cls];
+    const RDObjectGraphClassPlan *plan = it->second;
+
+    // Objects outside of the heap, such as constant strings and global blocks, cost nothing
+    chunk.sizes.push_back({ node.index, RDObjectAllocationSize(node.object) });
+    chunk.classes.push_back({ node.index, key });
+
+    const void *const *slots = (const void *const *)node.object;
+    for (size_t word = 0; word < plan->strongSlots.size(); ++word)
+        for (uint64_t bits = plan->strongSlots[word]; bits != 0; bits &= bits - 1)
+            RDObjectGraphVisit(visited, chunk, node.index, slots[word * 64 + __builtin_ctzll(bits)]);
+
+    if (!followsCollections)
+        return;
+
+    switch (plan->container) {
+        case RDObjectGraphContainerNone:
+            break;
+        case RDObjectGraphContainerArray:
+        case RDObjectGraphContainerSet:
+        case RDObjectGraphContainerOrderedSet:
+            for (__unsafe_unretained id element in (id<NSFastEnumeration>)object)
+                RDObjectGraphVisit(visited, chunk, node.index, (__bridge const void *)element);
+            break;
+        case RDObjectGraphContainerDictionary:
+            [(NSDictionary *)object enumerateKeysAndObjectsUsingBlock:^(id key, id value, BOOL *stop) {
+                RDObjectGraphVisit(visited, chunk, node.index, (__bridge const void *)key);
+                RDObjectGraphVisit(visited, chunk, node.index, (__bridge const void *)value);
+            }];
+            break;
+    }
+}
+
+- (RDObjectGraphReport *)analyzeRoots:(NSArray *)roots {
+    BOOL followsCollections = self.followsCollections;
+    RDObjectGraphVisitedSet visited;
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    std::vector<size_t> sizes(1, 0);
+    std::vector<const void *> classes(1, nullptr);
+
+    RDObjectGraphChunk seed;
+    for (id root in roots)
+        RDObjectGraphVisit(visited, seed, 0, (__bridge const void *)root);
+    std::vector<RDObjectGraphNode> frontier = std::move(seed.discovered);
+    edges = std::move(seed.edges);
+
+    // Level-synchronous traversal: every node of a level is scanned in parallel, discoveries form the next level
+    while (!frontier.empty()) {
+        NSUInteger chunkCount = MAX(1, MIN(frontier.size() / 256, _concurrency * 4));
+        std::vector<RDObjectGraphChunk> chunks(chunkCount);
+        RDObjectGraphChunk *chunksData = chunks.data();
+        const RDObjectGraphNode *frontierData = frontier.data();
+        size_t frontierCount = frontier.size();
+        RDObjectGraphVisitedSet *visitedSet = &visited;
+
+        dispatch_apply(chunkCount, RDUtilityQueue(), ^(size_t chunk) {
+            @autoreleasepool {
+                for (size_t i = chunk; i < frontierCount; i += chunkCount)
+                    RDObjectGraphScan(self, frontierData[i], *visitedSet, chunksData[chunk], followsCollections);
+            }
+        });
+
+        sizes.resize(visited.count(), 0);
+        classes.resize(visited.count(), nullptr);
+        frontier.clear();
+        for (RDObjectGraphChunk &chunk : chunks) {
+            for (auto &[index, size] : chunk.sizes)
+                sizes[index] = size;
+            for (auto &[index, cls] : chunk.classes)
+                classes[index] = cls;
+            edges.insert(edges.end(), chunk.edges.begin(), chunk.edges.end());
+            frontier.insert(frontier.end(), chunk.discovered.begin(), chunk.discovered.end());
+        }
+    }
+
+    size_t count = visited.count();
+    RDObjectGraphAdjacency successors(count, edges, false);
+    RDObjectGraphAdjacency predecessors(count, edges, true);
+    edges = {};
+
+    std::vector<uint32_t> order;
+    std::vector<uint32_t> idom = RDObjectGraphDominators(count, successors, predecessors, order);
+
+    // Dominators precede the nodes they dominate in reverse postorder, so walking it backwards sums subtrees bottom-up
+    std::vector<size_t> retained(sizes);
+    for (auto it = order.rbegin(); it != order.rend(); ++it)
+        if (*it != 0)
+            retained[idom[*it]] += retained[*it];
+
+    // Instances of a class nested under another instance of the same class are already part of that one's retained size
+    std::vector<uint32_t> classIndices(count, 0);
+    std::unordered_map<const void *, uint32_t> classIndex;
+    std::vector<const void *> classList;
+    for (size_t i = 1; i < count; ++i) {
+        auto [it, inserted] = classIndex.try_emplace(classes[i], (uint32_t)classList.size());
+        if (inserted)
+            classList.push_back(classes[i]);
+        classIndices[i] = it->second;
+    }
+
+    std::vector<NSUInteger> classCounts(classList.size(), 0);
+    std::vector<size_t> classShallow(classList.size(), 0);
+    std::vector<size_t> classRetained(classList.size(), 0);
+    std::vector<uint32_t> active(classList.size(), 0);
+    for (size_t i = 1; i < count; ++i) {
+        ++classCounts[classIndices[i]];
+        classShallow[classIndices[i]] += sizes[i];
+    }
+
+    std::vector<std::pair<uint32_t, uint32_t>> treeEdges;
+    treeEdges.reserve(count);
+    for (uint32_t node : order)
+        if (node != 0)
+            treeEdges.push_back({ idom[node], node });
+    RDObjectGraphAdjacency tree(count, treeEdges, false);
+
+    std::vector<std::pair<uint32_t, bool>> stack { { 0, false } };
+    while (!stack.empty()) {
+        auto [node, exiting] = stack.back();
+        stack.pop_back();
+        if (node != 0 && exiting) {
+            --active[classIndices[node]];
+            continue;
+        }
+
+        if (node != 0) {
+            if (active[classIndices[node]]++ == 0)
+                classRetained[classIndices[node]] += retained[node];
+            stack.push_back({ node, true });
+        }
+        tree.forEach(node, [&](uint32_t child) { stack.push_back({ child, false }); });
+    }
+
+    NSMutableArray<RDObjectGraphClassStatistics *> *statistics = [NSMutableArray arrayWithCapacity:classList.size()];
+    for (size_t i = 0; i < classList.size(); ++i)
+        [statistics addObject:[[RDObjectGraphClassStatistics alloc] initWithClass:(__bridge Class)classList[i]
+                                                                            count:classCounts[i]
+                                                                      shallowSize:classShallow[i]
+                                                                     retainedSize:classRetained[i]]];
+    [statistics sortUsingComparator:^NSComparisonResult(RDObjectGraphClassStatistics *a, RDObjectGraphClassStatistics *b) {
+        return a.retainedSize > b.retainedSize ? NSOrderedAscending
+             : a.retainedSize < b.retainedSize ? NSOrderedDescending
+             : NSOrderedSame;
+    }];
+
+    std::vector<size_t> rootRetainedSizes;
+    rootRetainedSizes.reserve(roots.count);
+    for (id root in roots) {
+        const void *pointer = (__bridge const void *)root;
+        if (RDIsTaggedPointer(pointer) || object_isClass(root))
+            rootRetainedSizes.push_back(0);
+        else
+            rootRetainedSizes.push_back(retained[visited.insert(pointer).first]);
+    }
+
+    return [[RDObjectGraphReport alloc] initWithObjectCount:count - 1
+                                                  totalSize:retained[0]
+                                            classStatistics:statistics
+                                          rootRetainedSizes:std::move(rootRetainedSizes)];
+}
+
+@end
@@ -2,6 +2,8 @@
 #import "Private/RDTypeTools.h"
 #import "Private/RDExternalDefs.h"
 #import "Private/RDUtils.h"
+#import "Private/RDMetricsTools.h"
+#import "Private/RDDescriberTools.h"
 
 #import <Foundation/Foundation.h>
 
@@ -0,0 +1,49 @@
+#import <Foundation/Foundation.h>
+#import "RDCommon.h"
+#import "RDType.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef struct {
+    NSString *name;
+    RDPropertySignature *signature;
+    RDPropertyAttributeFlags flags;
+    SEL getter;
+    // NULL for readonly properties
+    SEL _Nullable setter;
+    // Methods rather than IMPs, so method_setImplementation is honoured without rebuilding the table
+    Method _Nullable getterMethod;
+    Method _Nullable setterMethod;
+    // Class the methods were resolved against
+    __unsafe_unretained Class objcClass;
+    // RDOffsetUnknown when there is no backing ivar
+    RDOffset ivarOffset;
+} RDPropertyEntry;
+
+// Properties of a class and its superclasses, with accessors resolved against that class.
+// Tables are shared between threads and rebuilt on first use after the runtime generation changes;
+// dispose of runtime-built classes with RDDisposeClass, so their tables are dropped as well.
+RD_FINAL_CLASS
+@interface RDPropertyTable : NSObject
+
+@property (nonatomic, readonly, unsafe_unretained) Class objcClass;
+@property (nonatomic, readonly) uint64_t generation;
+@property (nonatomic, readonly) NSUInteger count;
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
++ (nullable instancetype)tableForClass:(Class)cls;
+
+// Entries live as long as the table
+- (nullable const RDPropertyEntry *)entryAtIndex:(NSUInteger)index;
+- (nullable const RDPropertyEntry *)entryWithName:(NSString *)name;
+
+@end
+
+// Call the accessors' current implementations directly; nil and NO for properties that are not object-typed.
+// Objects of another class than the table's, such as subclasses or KVO-observed objects, have the accessors looked up again.
+RD_EXTERN id _Nullable RDPropertyGetObject(const RDPropertyEntry *entry, id object);
+RD_EXTERN BOOL RDPropertySetObject(const RDPropertyEntry *entry, id object, id _Nullable value);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,131 @@
+#import "RDPropertyTable.h"
+#import "RDSmoke.h"
+#import "RDMirror.h"
+#import "RDPrivate.h"
+
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+static SEL RDPropertyDefaultSetter(NSString *name) {
+    NSString *head = [name substringToIndex:1].uppercaseString;
+    return NSSelectorFromString([NSString stringWithFormat:@"set%@%@:", head, [name substringFromIndex:1]]);
+}
+
+@implementation RDPropertyTable {
+    std::vector<RDPropertyEntry> _entries;
+    NSDictionary<NSString *, NSNumber *> *_indices;
+}
+
+- (instancetype)initWithObjcClass:(Class)cls smoke:(RDSmoke *)smoke generation:(uint64_t)generation {
+    self = [super init];
+    if (self) {
+        _objcClass = cls;
+        _generation = generation;
+
+        // Subclasses come first, so redeclared properties resolve to the most derived declaration
+        NSMutableDictionary<NSString *, NSNumber *> *indices = [NSMutableDictionary dictionary];
+        for (Class c = cls; c != Nil; c = class_getSuperclass(c))
+            for (RDProperty *property in [smoke mirrorForObjcClass:c].properties) {
+                RDPropertySignature *signature = property.signature;
+                if (property.name.length == 0 || signature == nil || indices[property.name] != nil)
+                    continue;
+
+                RDPropertyEntry entry = {
+                    .name = property.name,
+                    .signature = signature,
+                    .flags = signature.flags,
+                    .getter = signature.getter ?: NSSelectorFromString(property.name),
+                    .setter = (signature.flags & RDPropertyAttributeFlagReadOnly) ? (SEL)NULL
+                            : signature.setter ?: RDPropertyDefaultSetter(property.name),
+                    .objcClass = cls,
+                    .ivarOffset = RDOffsetUnknown,
+                };
+                entry.getterMethod = class_getInstanceMethod(cls, entry.getter);
+                entry.setterMethod = entry.setter == NULL ? NULL : class_getInstanceMethod(cls, entry.setter);
+                if (NSString *ivarName = signature.ivarName; ivarName.length > 0)
+                    if (Ivar ivar = class_getInstanceVariable(cls, ivarName.UTF8String))
+                        entry.ivarOffset = ivar_getOffset(ivar);
+
+                indices[property.name] = @(_entries.size());
+                _entries.push_back(entry);
+            }
+        _indices = [indices copy];
+    }
+    return self;
+}
+
++ (instancetype)tableForClass:(Class)cls {
+    static std::shared_mutex lock;
+    static auto *tables = new std::unordered_map<const void *, RDPropertyTable *>();
+    static RDSmoke *smoke = [RDSmoke new];
+    static uint64_t sweptGeneration = 0;
+
+    if (cls == Nil)
+        return nil;
+
+    const void *key = (__bridge const void *)cls;
+    uint64_t generation = RDRuntimeGeneration();
+    {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        if (auto it = tables->find(key); it != tables->end() && it->second->_generation == generation)
+            return it->second;
+    }
+
+    std::unique_lock<std::shared_mutex> guard(lock);
+    // Stale tables would be rebuilt on their next lookup anyway; dropping them lets go of disposed classes
+    if (sweptGeneration != generation) {
+        for (auto it = tables->begin(); it != tables->end();)
+            it = it->second->_generation != generation ? tables->erase(it) : std::next(it);
+        sweptGeneration = generation;
+    }
+
+    RDPropertyTable *__strong &table = (*tables)[key];
+    if (table == nil || table->_generation != generation)
+        table = [[RDPropertyTable alloc] initWithObjcClass:cls smoke:smoke generation:generation];
+    return table;
+}
+
+- (NSUInteger)count {
+    return _entries.size();
+}
+
+- (const RDPropertyEntry *)entryAtIndex:(NSUInteger)index {
+    return index < _entries.size() ? &_entries[index] : NULL;
+}
+
+- (const RDPropertyEntry *)entryWithName:(NSString *)name {
+    NSNumber *index = _indices[name];
+    return index == nil ? NULL : &_entries[index.unsignedIntegerValue];
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %@, %lu properties>", self.class, self.objcClass, (unsigned long)self.count];
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Overrides and KVO setters live on the object's own class, which may be a subclass of the table's
+static IMP RDPropertyImplementation(const RDPropertyEntry *entry, Method method, SEL selector, id object) {
+    Class cls = object_getClass(object);
+    return cls == entry->objcClass ? method_getImplementation(method) : class_getMethodImplementation(cls, selector);
+}
+
+RD_EXTERN id _Nullable RDPropertyGetObject(const RDPropertyEntry *entry, id object) {
+    if (entry->getterMethod == NULL || RD_CAST(entry->signature.type, RDObjectType) == nil)
+        return nil;
+
+    IMP getter = RDPropertyImplementation(entry, entry->getterMethod, entry->getter, object);
+    return ((id (*)(id, SEL))getter)(object, entry->getter);
+}
+
+RD_EXTERN BOOL RDPropertySetObject(const RDPropertyEntry *entry, id object, id _Nullable value) {
+    if (entry->setterMethod == NULL || RD_CAST(entry->signature.type, RDObjectType) == nil)
+        return NO;
+
+    IMP setter = RDPropertyImplementation(entry, entry->setterMethod, entry->setter, object);
+    ((void (*)(id, SEL, id))setter)(object, entry->setter, value);
+    return YES;
+}
@@ -1,6 +1,7 @@
 #import "RDReflection.h"
 #import "RDPrivate.h"
 #import "RDSmoke.h"
+#import "RDDescriber.h"
 
 @implementation RDReflection
 
@@ -30,7 +31,12 @@
 }
 
 - (NSString *)description {
-    return [self stringRepresentationWithExtra:NULL];
+    RDDescriber *describer = [RDDescriber new];
+    describer.smoke = self.smoke;
+    describer.maxDepth = NSUIntegerMax;
+    describer.maxElements = NSUIntegerMax;
+    [describer describeObject:self.object];
+    return describer.string;
 }
 
 - (NSString *)debugDescription {
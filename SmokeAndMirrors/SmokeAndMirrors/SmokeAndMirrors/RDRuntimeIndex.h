@@ -0,0 +1,36 @@
+#import <Foundation/Foundation.h>
+#import "RDCommon.h"
+#import "RDMirror.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef void (^RDRuntimeIndexIvarBlock)(Class cls, RDIvar *ivar, BOOL *stop);
+
+// Thread-safe; queries may run concurrently with each other and with -refresh.
+// Classes disposed with RDDisposeClass drop out before the next query; ones disposed any other way are not noticed.
+RD_FINAL_CLASS
+@interface RDRuntimeIndex : NSObject
+
+@property (nonatomic, readonly) NSUInteger classCount;
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+- (instancetype)initWithConcurrency:(NSUInteger)concurrency NS_DESIGNATED_INITIALIZER;
+
+// Built on first access
++ (instancetype)sharedIndex;
+
+// Mirrors classes registered since the last refresh and merges them into the index; returns how many were added
+- (NSUInteger)refresh;
+
+- (NSArray<Class> *)classesImplementingInstanceSelector:(SEL)selector;
+- (NSArray<Class> *)classesImplementingClassSelector:(SEL)selector;
+// Includes conformance through inherited protocols and superclasses, same as +conformsToProtocol:
+- (NSArray<Class> *)classesConformingToProtocol:(Protocol *)protocol;
+// Field and class names are not compared, so types made from @encode match ivars declared with them
+- (NSArray<Class> *)classesWithIvarOfType:(RDType *)type;
+- (void)enumerateIvarsOfType:(RDType *)type usingBlock:(NS_NOESCAPE RDRuntimeIndexIvarBlock)block;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,297 @@
+#import "RDRuntimeIndex.h"
+#import "RDSmoke.h"
+#import "RDMirrorPrivate.h"
+#import "RDPrivate.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+struct RDRuntimeIndexIvar {
+    __unsafe_unretained Class cls;
+    RDIvar *ivar;
+};
+
+struct RDRuntimeIndexTables {
+    std::unordered_map<SEL, std::vector<__unsafe_unretained Class>> instanceSelectors;
+    std::unordered_map<SEL, std::vector<__unsafe_unretained Class>> classSelectors;
+    std::unordered_map<std::string, std::vector<__unsafe_unretained Class>> conformers;
+    std::unordered_map<std::string, std::vector<RDRuntimeIndexIvar>> ivars;
+    std::unordered_map<const void *, std::vector<__unsafe_unretained Class>> subclasses;
+
+    template<typename K, typename V>
+    static void merge(std::unordered_map<K, std::vector<V>> &into, std::unordered_map<K, std::vector<V>> &from) {
+        for (auto &[key, values] : from) {
+            std::vector<V> &target = into[key];
+            target.insert(target.end(), std::make_move_iterator(values.begin()), std::make_move_iterator(values.end()));
+        }
+    }
+
+    void merge(RDRuntimeIndexTables &other) {
+        merge(instanceSelectors, other.instanceSelectors);
+        merge(classSelectors, other.classSelectors);
+        merge(conformers, other.conformers);
+        merge(ivars, other.ivars);
+        merge(subclasses, other.subclasses);
+    }
+
+    static const void *key(__unsafe_unretained Class cls) { return (__bridge const void *)cls; }
+    static const void *key(const RDRuntimeIndexIvar &ivar) { return (__bridge const void *)ivar.cls; }
+
+    template<typename K, typename V>
+    static void remove(std::unordered_map<K, std::vector<V>> &from, const std::unordered_set<const void *> &classes) {
+        for (auto it = from.begin(); it != from.end();) {
+            std::vector<V> &values = it->second;
+            values.erase(std::remove_if(values.begin(), values.end(), [&](const V &value) { return classes.count(key(value)) > 0; }), values.end());
+            it = values.empty() ? from.erase(it) : std::next(it);
+        }
+    }
+
+    void remove(const std::unordered_set<const void *> &classes) {
+        remove(instanceSelectors, classes);
+        remove(classSelectors, classes);
+        remove(conformers, classes);
+        remove(ivars, classes);
+        remove(subclasses, classes);
+        for (const void *cls : classes)
+            subclasses.erase(cls);
+    }
+};
+
+// Runtime ivar encodings carry field and class names that @encode leaves out: {?="x"i"y"i} against {?=ii}
+static std::string RDRuntimeIndexIvarKey(const char *encoding) {
+    std::string key;
+    for (const char *it = encoding; *it != '\0'; ++it)
+        if (*it == '"')
+            while (it[1] != '\0' && *++it != '"');
+        else
+            key.push_back(*it);
+    return key;
+}
+
+static void RDRuntimeIndexAddProtocol(RDRuntimeIndexTables &tables, Class cls, RDProtocol *protocol,
+                                      std::unordered_set<const void *> &visited)
+{
+    if (!visited.insert((__bridge const void *)protocol).second)
+        return;
+
+    tables.conformers[protocol.name.UTF8String].push_back(cls);
+    for (RDProtocol *inherited in protocol.protocols)
+        RDRuntimeIndexAddProtocol(tables, cls, inherited, visited);
+}
+
+static void RDRuntimeIndexAddClass(RDRuntimeIndexTables &tables, RDSmoke *smoke, Class cls) {
+    RDClass *mirror = [smoke mirrorForObjcClass:cls];
+    if (mirror == nil)
+        return;
+
+    for (RDMethod *method in mirror.methods)
+        tables.instanceSelectors[method.selector].push_back(cls);
+
+    if (Class meta = object_getClass(cls); meta != Nil && meta != cls)
+        for (RDMethod *method in [smoke mirrorForObjcClass:meta].methods)
+            tables.classSelectors[method.selector].push_back(cls);
+
+    std::unordered_set<const void *> visited;
+    for (RDProtocol *protocol in mirror.protocols)
+        RDRuntimeIndexAddProtocol(tables, cls, protocol, visited);
+
+    for (RDIvar *ivar in mirror.ivars)
+        if (const char *encoding = ivar.type.objCTypeEncoding; encoding != NULL)
+            tables.ivars[RDRuntimeIndexIvarKey(encoding)].push_back({ cls, ivar });
+
+    if (Class superclass = class_getSuperclass(cls); superclass != Nil)
+        tables.subclasses[(__bridge const void *)superclass].push_back(cls);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@implementation RDRuntimeIndex {
+    NSUInteger _concurrency;
+    std::shared_mutex _lock;
+    std::mutex _refreshLock;
+    // Runtime generation each class was indexed at, so that classes disposed since can be told apart from their successors
+    std::unordered_map<const void *, uint64_t> _indexed;
+    std::atomic<uint64_t> _disposalsSeen;
+    RDRuntimeIndexTables _tables;
+}
+
++ (instancetype)sharedIndex {
+    static RDRuntimeIndex *index = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        index = [[RDRuntimeIndex alloc] initWithConcurrency:0];
+        [index refresh];
+    });
+    return index;
+}
+
+- (instancetype)initWithConcurrency:(NSUInteger)concurrency {
+    self = [super init];
+    if (self) {
+        _concurrency = concurrency > 0 ? concurrency : NSProcessInfo.processInfo.activeProcessorCount;
+    }
+    return self;
+}
+
+- (void)_removeDisposedClasses {
+    uint64_t lastDisposal = RDLastClassDisposal();
+    if (lastDisposal <= _disposalsSeen.load(std::memory_order_acquire))
+        return;
+
+    std::unique_lock<std::shared_mutex> guard(_lock);
+    if (lastDisposal <= _disposalsSeen.load(std::memory_order_relaxed))
+        return;
+
+    std::unordered_set<const void *> disposed;
+    for (auto it = _indexed.begin(); it != _indexed.end();)
+        if (RDClassDisposedSince(it->first, it->second)) {
+            disposed.insert(it->first);
+            it = _indexed.erase(it);
+        } else {
+            ++it;
+        }
+
+    if (!disposed.empty())
+        _tables.remove(disposed);
+    _disposalsSeen.store(lastDisposal, std::memory_order_release);
+}
+
+- (NSUInteger)classCount {
+    [self _removeDisposedClasses];
+    std::shared_lock<std::shared_mutex> guard(_lock);
+    return _indexed.size();
+}
+
+- (NSUInteger)refresh {
+    std::lock_guard<std::mutex> refreshGuard(_refreshLock);
+    [self _removeDisposedClasses];
+
+    uint64_t generation = RDRuntimeGeneration();
+    std::vector<__unsafe_unretained Class> pending;
+    {
+        unsigned count = 0;
+        Class *classList = objc_copyClassList(&count);
+        std::shared_lock<std::shared_mutex> guard(_lock);
+        for (unsigned i = 0; i < count; ++i)
+            if (_indexed.find((__bridge const void *)classList[i]) == _indexed.end())
+                pending.push_back(classList[i]);
+        free(classList);
+    }
+
+    if (pending.empty())
+        return 0;
+
+    // Many more chunks than workers, so that threads done with cheap classes pick up the rest of the heavy ones
+    NSUInteger chunkCount = MIN(pending.size(), _concurrency * 8);
+    std::vector<RDRuntimeIndexTables> shards(chunkCount);
+    RDRuntimeIndexTables *shardsData = shards.data();
+    __unsafe_unretained Class *pendingData = pending.data();
+    NSUInteger pendingCount = pending.size();
+
+    dispatch_apply(chunkCount, RDUtilityQueue(), ^(size_t chunk) {
+        @autoreleasepool {
+            // RDSmoke is not thread-safe, so every chunk mirrors into its own one
+            RDSmoke *smoke = [RDSmoke new];
+            for (NSUInteger i = chunk; i < pendingCount; i += chunkCount)
+                RDRuntimeIndexAddClass(shardsData[chunk], smoke, pendingData[i]);
+        }
+    });
+
+    std::unique_lock<std::shared_mutex> guard(_lock);
+    for (RDRuntimeIndexTables &shard : shards)
+        _tables.merge(shard);
+    for (Class cls : pending)
+        _indexed.emplace((__bridge const void *)cls, generation);
+    return pending.size();
+}
+
+static NSArray<Class> *RDRuntimeIndexClasses(const std::vector<__unsafe_unretained Class> *classes) {
+    if (classes == nullptr || classes->empty())
+        return @[];
+
+    return [NSArray arrayWithObjects:(__unsafe_unretained id const *)(const void *)classes->data() count:classes->size()];
+}
+
+template<typename K>
+static const std::vector<__unsafe_unretained Class> *RDRuntimeIndexFind(const std::unordered_map<K, std::vector<__unsafe_unretained Class>> &map, const K &key) {
+    auto it = map.find(key);
+    return it == map.end() ? nullptr : &it->second;
+}
+
+- (NSArray<Class> *)classesImplementingInstanceSelector:(SEL)selector {
+    [self _removeDisposedClasses];
+    std::shared_lock<std::shared_mutex> guard(_lock);
+    return RDRuntimeIndexClasses(RDRuntimeIndexFind(_tables.instanceSelectors, selector));
+}
+
+- (NSArray<Class> *)classesImplementingClassSelector:(SEL)selector {
+    [self _removeDisposedClasses];
+    std::shared_lock<std::shared_mutex> guard(_lock);
+    return RDRuntimeIndexClasses(RDRuntimeIndexFind(_tables.classSelectors, selector));
+}
+
+- (NSArray<Class> *)classesConformingToProtocol:(Protocol *)protocol {
+    [self _removeDisposedClasses];
+    std::shared_lock<std::shared_mutex> guard(_lock);
+    auto declared = RDRuntimeIndexFind(_tables.conformers, std::string(protocol_getName(protocol)));
+    if (declared == nullptr)
+        return @[];
+
+    std::vector<__unsafe_unretained Class> result;
+    std::unordered_set<const void *> visited;
+    std::vector<__unsafe_unretained Class> queue(declared->begin(), declared->end());
+    while (!queue.empty()) {
+        __unsafe_unretained Class cls = queue.back();
+        queue.pop_back();
+        if (!visited.insert((__bridge const void *)cls).second)
+            continue;
+
+        result.push_back(cls);
+        if (auto subclasses = RDRuntimeIndexFind(_tables.subclasses, (__bridge const void *)cls); subclasses != nullptr)
+            queue.insert(queue.end(), subclasses->begin(), subclasses->end());
+    }
+    return RDRuntimeIndexClasses(&result);
+}
+
+- (NSArray<Class> *)classesWithIvarOfType:(RDType *)type {
+    const char *encoding = type.objCTypeEncoding;
+    if (encoding == NULL)
+        return @[];
+
+    std::string key = RDRuntimeIndexIvarKey(encoding);
+    std::vector<__unsafe_unretained Class> result;
+    [self _removeDisposedClasses];
+    std::shared_lock<std::shared_mutex> guard(_lock);
+    if (auto it = _tables.ivars.find(key); it != _tables.ivars.end())
+        for (const RDRuntimeIndexIvar &match : it->second)
+            if (result.empty() || result.back() != match.cls)
+                result.push_back(match.cls);
+    return RDRuntimeIndexClasses(&result);
+}
+
+- (void)enumerateIvarsOfType:(RDType *)type usingBlock:(NS_NOESCAPE RDRuntimeIndexIvarBlock)block {
+    const char *encoding = type.objCTypeEncoding;
+    if (encoding == NULL)
+        return;
+
+    std::string key = RDRuntimeIndexIvarKey(encoding);
+    std::vector<RDRuntimeIndexIvar> matches;
+    [self _removeDisposedClasses];
+    {
+        std::shared_lock<std::shared_mutex> guard(_lock);
+        if (auto it = _tables.ivars.find(key); it != _tables.ivars.end())
+            matches = it->second;
+    }
+
+    BOOL stop = NO;
+    for (auto it = matches.begin(); it != matches.end() && !stop; ++it)
+        block(it->cls, it->ivar, &stop);
+}
+
+@end
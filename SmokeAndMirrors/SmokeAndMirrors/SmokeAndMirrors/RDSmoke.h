@@ -3,11 +3,47 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+typedef NS_ENUM(NSInteger, RDSmokeRetentionPolicy) {
+    // Mirrors live only as long as something outside the smoke references them
+    RDSmokeRetentionPolicyWeak,
+    // Every mirror lives as long as the smoke
+    RDSmokeRetentionPolicyKeepAll,
+    // Recently used mirrors are kept until their estimated sizes exceed the byte budget;
+    // a mirror's size includes the members it alone keeps alive, which are evicted along with it
+    RDSmokeRetentionPolicyLRU,
+};
+
+RD_EXTERN NSUInteger const RDSmokeConstructedHistoryLimit;
+
+// Counts requests made to the smoke; mirrors built along with a requested one, such as a class's methods, are left out
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    // Misses for items that had been requested before and were freed or evicted since;
+    // only the last RDSmokeConstructedHistoryLimit distinct items are remembered, so this may undercount
+    uint64_t rebuilds;
+    uint64_t evictions;
+    NSUInteger retainedCount;
+    size_t retainedBytes;
+} RDSmokeStatistics;
+
 RD_FINAL_CLASS
 @interface RDSmoke : NSObject
 
 @property (nonatomic, readonly, class) RDSmoke *currentThreadSmoke;
 
+@property (nonatomic, readonly) RDSmokeRetentionPolicy retentionPolicy;
+@property (nonatomic, readonly) size_t byteBudget;
+@property (nonatomic, readonly) RDSmokeStatistics statistics;
+
+- (instancetype)init;
+// byteBudget is only used by RDSmokeRetentionPolicyLRU
+- (instancetype)initWithRetentionPolicy:(RDSmokeRetentionPolicy)retentionPolicy byteBudget:(size_t)byteBudget NS_DESIGNATED_INITIALIZER;
+
+// Drops every mirror retained by the policy; mirrors referenced elsewhere stay cached
+- (void)purge;
+- (void)resetStatistics;
+
 - (RDClass *)mirrorForObjcClass:(Class)cls;
 - (RDProtocol *)mirrorForObjcProtocol:(Protocol *)protocol;
 - (RDMethod *)mirrorForObjcMethod:(Method)method;
@@ -2,7 +2,9 @@
 #import "RDMirrorPrivate.h"
 #import "RDPrivate.h"
 
+#include <list>
 #include <unordered_map>
+#include <unordered_set>
 
 RD_FINAL_CLASS
 @interface RDObjcOpaqueItem : NSObject<NSCopying>
@@ -76,11 +78,42 @@ RD_FINAL_CLASS
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+NSUInteger const RDSmokeConstructedHistoryLimit = 1 << 14;
+
+struct RDSmokeRetainedMirror {
+    RDMirror *mirror;
+    size_t size;
+};
+
+// Items of different kinds may share an address, so the kind is part of the key
+struct RDSmokeItemKey {
+    uintptr_t value;
+    RDMetricsCounter kind;
+
+    bool operator==(const RDSmokeItemKey &other) const {
+        return value == other.value && kind == other.kind;
+    }
+};
+
+struct RDSmokeItemKeyHash {
+    size_t operator()(const RDSmokeItemKey &key) const {
+        return std::hash<uintptr_t>()(key.value) ^ (size_t)key.kind;
+    }
+};
+
 @interface RDSmoke()
 @property (nonatomic, readonly) NSMapTable<RDObjcOpaqueItem *, __kindof RDMirror *> *cache;
 @end
 
-@implementation RDSmoke
+@implementation RDSmoke {
+    // Most recently used first; the weak cache stays the only index by item
+    std::list<RDSmokeRetainedMirror> _retained;
+    std::unordered_map<const void *, std::list<RDSmokeRetainedMirror>::iterator> _retainedIndex;
+    std::unordered_set<RDSmokeItemKey, RDSmokeItemKeyHash> _constructed;
+    RDSmokeStatistics _statistics;
+    // Above zero while a mirror is being built, so that the mirrors it pulls in along the way are told from requested ones
+    NSUInteger _constructionDepth;
+}
 
 + (RDSmoke *)currentThreadSmoke {
     static NSString *const kSmokeThreadDictKey = @"RDSmoke";
@@ -93,23 +126,106 @@ RD_FINAL_CLASS
 }
 
 - (instancetype)init {
+    return [self initWithRetentionPolicy:RDSmokeRetentionPolicyWeak byteBudget:0];
+}
+
+- (instancetype)initWithRetentionPolicy:(RDSmokeRetentionPolicy)retentionPolicy byteBudget:(size_t)byteBudget {
     self = [super init];
     if (self) {
         _cache = [NSMapTable strongToWeakObjectsMapTable];
+        _retentionPolicy = retentionPolicy;
+        _byteBudget = byteBudget;
     }
     return self;
 }
 
+- (RDSmokeStatistics)statistics {
+    RDSmokeStatistics statistics = _statistics;
+    statistics.retainedCount = _retained.size();
+    return statistics;
+}
+
+- (void)resetStatistics {
+    size_t retainedBytes = _statistics.retainedBytes;
+    _statistics = (RDSmokeStatistics) { .retainedBytes = retainedBytes };
+}
+
+- (void)purge {
+    _retainedIndex.clear();
+    _retained.clear();
+    _statistics.retainedBytes = 0;
+}
+
+- (void)retainMirror:(__kindof RDMirror *)mirror {
+    if (mirror == nil || self.retentionPolicy == RDSmokeRetentionPolicyWeak)
+        return;
+
+    if (auto it = _retainedIndex.find((__bridge const void *)mirror); it != _retainedIndex.end())
+        return _retained.splice(_retained.begin(), _retained, it->second);
+
+    size_t size = [mirror _estimatedSize];
+    _retained.push_front({ mirror, size });
+    _retainedIndex[(__bridge const void *)mirror] = _retained.begin();
+    _statistics.retainedBytes += size;
+
+    if (self.retentionPolicy != RDSmokeRetentionPolicyLRU)
+        return;
+
+    // The newest mirror is kept even if it alone exceeds the budget
+    while (_statistics.retainedBytes > self.byteBudget && _retained.size() > 1) {
+        RDSmokeRetainedMirror &victim = _retained.back();
+        _statistics.retainedBytes -= victim.size;
+        ++_statistics.evictions;
+        _retainedIndex.erase((__bridge const void *)victim.mirror);
+        _retained.pop_back();
+    }
+}
+
+- (void)forgetMirror:(__kindof RDMirror *)mirror forItem:(RDObjcOpaqueItem *)item {
+    [self.cache removeObjectForKey:item];
+    if (auto it = _retainedIndex.find((__bridge const void *)mirror); it != _retainedIndex.end()) {
+        _statistics.retainedBytes -= it->second->size;
+        _retained.erase(it->second);
+        _retainedIndex.erase(it);
+    }
+}
+
+- (void)_buildMembers:(NS_NOESCAPE void (^)(void))block {
+    ++_constructionDepth;
+    block();
+    --_constructionDepth;
+}
+
 - (__kindof RDMirror *)mirrorForItem:(RDObjcOpaqueItem *)item
+                       constructions:(RDMetricsCounter)counter
                        valueProducer:(__kindof RDMirror *(NS_NOESCAPE ^)())producer
 {
+    // Mirrors built along with another one live as long as it does, so only requested ones are counted and retained
+    bool requested = _constructionDepth == 0;
     __kindof RDMirror *mirror = [self.cache objectForKey:item];
     if (mirror != nil) {
-        return mirror;
+        RDMetricsIncrement(RDMetricsCounterSmokeCacheHit);
+        if (requested)
+            ++_statistics.hits;
     } else {
+        RDMetricsIncrement(RDMetricsCounterSmokeCacheMiss);
+        RDMetricsIncrement(counter);
+        if (requested) {
+            ++_statistics.misses;
+            if (_constructed.size() >= RDSmokeConstructedHistoryLimit)
+                _constructed.clear();
+            if (!_constructed.insert({ (uintptr_t)item.hash, counter }).second)
+                ++_statistics.rebuilds;
+        }
+
+        RD_METRICS_TIME(RDMetricsTimerMirrorConstruction);
+        ++_constructionDepth;
         mirror = producer();
+        --_constructionDepth;
         [self.cache setObject:mirror forKey:item];
     }
+    if (requested)
+        [self retainMirror:mirror];
     return mirror;
 }
 
@@ -117,7 +233,15 @@ RD_FINAL_CLASS
     if (cls == Nil)
         return nil;
     
-    return [self mirrorForItem:[RDObjcOpaqueItem itemWithClass:cls] valueProducer:^RDClass *{
+    RDObjcOpaqueItem *item = [RDObjcOpaqueItem itemWithClass:cls];
+    // The class the cached mirror describes may have been disposed, and cls be a new one allocated at its address
+    if (RDLastClassDisposal() != 0)
+        if (RDClass *cached = [self.cache objectForKey:item]; cached != nil && RDClassDisposedSince((__bridge const void *)cls, cached.builtGeneration))
+            [self forgetMirror:cached forItem:item];
+
+    return [self mirrorForItem:item
+                 constructions:RDMetricsCounterClassMirrorConstruction
+                 valueProducer:^RDClass *{
         return [[RDClass alloc] initWithObjcClass:cls inSmoke:self];
     }];
 }
@@ -127,7 +251,9 @@ RD_FINAL_CLASS
     if (protocol == nil)
         return nil;
     
-    return [self mirrorForItem:[RDObjcOpaqueItem itemWithProtocol:protocol] valueProducer:^RDProtocol *{
+    return [self mirrorForItem:[RDObjcOpaqueItem itemWithProtocol:protocol]
+                 constructions:RDMetricsCounterProtocolMirrorConstruction
+                 valueProducer:^RDProtocol *{
         return [[RDProtocol alloc] initWithObjcProtocol:protocol inSmoke:self];
     }];
 }
@@ -136,7 +262,9 @@ RD_FINAL_CLASS
     if (method == NULL)
         return nil;
     
-    return [self mirrorForItem:[RDObjcOpaqueItem itemWithMethod:method] valueProducer:^RDMirror *{
+    return [self mirrorForItem:[RDObjcOpaqueItem itemWithMethod:method]
+                 constructions:RDMetricsCounterMethodMirrorConstruction
+                 valueProducer:^RDMirror *{
         return [[RDMethod alloc] initWithObjcMethod:method inSmoke:self];
     }];
 }
@@ -145,7 +273,9 @@ RD_FINAL_CLASS
     if (property == NULL)
         return nil;
     
-    return [self mirrorForItem:[RDObjcOpaqueItem itemWithProperty:property] valueProducer:^RDMirror *{
+    return [self mirrorForItem:[RDObjcOpaqueItem itemWithProperty:property]
+                 constructions:RDMetricsCounterPropertyMirrorConstruction
+                 valueProducer:^RDMirror *{
         return [[RDProperty alloc] initWithObjcProperty:property inSmoke:self];
     }];
 }
@@ -154,7 +284,9 @@ RD_FINAL_CLASS
     if (ivar == NULL)
         return nil;
     
-    return [self mirrorForItem:[RDObjcOpaqueItem itemWithIvar:ivar] valueProducer:^__kindof RDMirror *{
+    return [self mirrorForItem:[RDObjcOpaqueItem itemWithIvar:ivar]
+                 constructions:RDMetricsCounterIvarMirrorConstruction
+                 valueProducer:^__kindof RDMirror *{
         return [[RDIvar alloc] initWithObjcIvar:ivar inSmoke:self];
     }];
 }
@@ -164,7 +296,9 @@ RD_FINAL_CLASS
         return nil;
     
     RDBlockInfo *blockInfo = RDGetBlockInfo(block);
-    return [self mirrorForItem:[RDObjcOpaqueItem itemWithPointer:blockInfo->descriptor] valueProducer:^RDMirror *{
+    return [self mirrorForItem:[RDObjcOpaqueItem itemWithPointer:blockInfo->descriptor]
+                 constructions:RDMetricsCounterBlockMirrorConstruction
+                 valueProducer:^RDMirror *{
         return [[RDBlock alloc] initWithBlockInfo:blockInfo inSmoke:self];
     }];
 }
@@ -0,0 +1,204 @@
+#import <Foundation/Foundation.h>
+#import <objc/runtime.h>
+#import "RDCommon.h"
+#import "RDType.h"
+#import "RDValue.h"
+#import "RDMirror.h"
+
+#if defined(__cplusplus) && defined(__OBJC__)
+
+#include <array>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Statically typed counterparts of RDValueGet/RDValueSet and RDInvocation.
+// Types are derived from @encode at compile time and checked against the runtime type once per thread;
+// after that accesses are plain loads and stores, and calls go straight to the IMP.
+namespace rd {
+
+    // Parsed once per T
+    template<typename T>
+    RDType *type() {
+        static RDType *const type = [RDType typeWithObjcTypeEncoding:@encode(T)];
+        return type;
+    }
+
+    namespace detail {
+
+        template<typename T>
+        inline constexpr bool is_storable_v = std::is_trivially_copyable_v<T> || std::is_convertible_v<T, id>;
+
+        // Small per-thread cache of field lookups for a given T; entries keep their type alive, so pointer identity is safe
+        template<typename T>
+        class field_cache {
+        public:
+            RDOffset offset(RDValue *value, const void *_Nullable bytes, RDType *valueType, const char *_Nullable field) {
+                for (entry &e : _entries)
+                    if (e.type == valueType && (field == nullptr ? e.whole : !e.whole && e.field == field))
+                        return e.offset;
+
+                entry &e = _entries[_next++ % _entries.size()];
+                e.type = valueType;
+                e.whole = field == nullptr;
+                e.field = field ?: "";
+                e.offset = resolve(value, bytes, field);
+                return e.offset;
+            }
+
+        private:
+            struct entry {
+                RDType *_Nullable type = nil;
+                bool whole = false;
+                std::string field;
+                RDOffset offset = RDOffsetUnknown;
+            };
+
+            std::array<entry, 8> _entries;
+            size_t _next = 0;
+
+            static RDOffset resolve(RDValue *value, const void *_Nullable bytes, const char *_Nullable field) {
+                RDType *fieldType = nil;
+                const uint8_t *buffer = field == nullptr
+                                      ? [value bufferType:&fieldType]
+                                      : [value bufferforKey:@(field) type:&fieldType];
+                if (buffer == NULL || bytes == NULL || (uintptr_t)buffer % alignof(T) != 0)
+                    return RDOffsetUnknown;
+
+                // Both directions, so the same entry serves reads and writes
+                RDType *type = rd::type<T>();
+                if (![type isAssignableFromType:fieldType] || ![fieldType isAssignableFromType:type] || fieldType.size != sizeof(T))
+                    return RDOffsetUnknown;
+
+                return buffer - (const uint8_t *)bytes;
+            }
+        };
+
+        template<typename T>
+        T *_Nullable locate(RDValue *value, const char *_Nullable field) {
+            static thread_local field_cache<T> cache;
+            if (value == nil)
+                return nullptr;
+
+            RDType *valueType = nil;
+            const uint8_t *bytes = [value bufferType:&valueType];
+            RDOffset offset = cache.offset(value, bytes, valueType, field);
+            return offset == RDOffsetUnknown ? nullptr : (T *)(bytes + offset);
+        }
+
+        struct method_key {
+            const void *cls;
+            SEL selector;
+
+            bool operator==(const method_key &other) const {
+                return cls == other.cls && selector == other.selector;
+            }
+        };
+
+        struct method_key_hash {
+            size_t operator()(const method_key &key) const {
+                return std::hash<const void *>()(key.cls) ^ (std::hash<const void *>()((const void *)key.selector) << 1);
+            }
+        };
+
+        // Method rather than IMP is cached, so method_setImplementation is honoured without invalidation
+        template<typename R, typename ... Args>
+        class method_cache {
+        public:
+            Method _Nullable lookup(Class cls, SEL selector) {
+                if (uint64_t generation = RDRuntimeGeneration(); generation != _generation) {
+                    _methods.clear();
+                    _generation = generation;
+                }
+
+                auto [it, inserted] = _methods.try_emplace({ (__bridge const void *)cls, selector }, nullptr);
+                if (inserted)
+                    it->second = resolve(cls, selector);
+                return it->second;
+            }
+
+        private:
+            std::unordered_map<method_key, Method _Nullable, method_key_hash> _methods;
+            uint64_t _generation = 0;
+
+            static Method _Nullable resolve(Class cls, SEL selector) {
+                Method method = class_getInstanceMethod(cls, selector);
+                if (method == NULL)
+                    return NULL;
+
+                RDMethodSignature *signature = [RDMethodSignature signatureWithObjcTypeEncoding:method_getTypeEncoding(method)];
+                if (signature == nil || !signature.isMethodSignature || signature.argumentsCount != sizeof...(Args) + 2)
+                    return NULL;
+
+                RDType *returnType = signature.returnValue->type;
+                if constexpr (std::is_void_v<R>) {
+                    if (!RD_CAST(returnType, RDVoidType))
+                        return NULL;
+                } else if (![rd::type<R>() isAssignableFromType:returnType]) {
+                    return NULL;
+                }
+
+                NSUInteger index = 2;
+                (void)index;
+                bool matches = (... && [[signature argumentAtIndex:index++]->type isAssignableFromType:rd::type<Args>()]);
+                return matches ? method : NULL;
+            }
+        };
+
+    }
+
+    // Whole value when field is NULL; empty when the field is missing or its type differs from T
+    template<typename T>
+    std::optional<T> get(RDValue *_Nullable value, const char *_Nullable field = nullptr) {
+        static_assert(detail::is_storable_v<T>, "T must be trivially copyable or an object pointer");
+        if (T *slot = detail::locate<T>(value, field); slot != nullptr)
+            return *slot;
+        return std::nullopt;
+    }
+
+    // Object fields are retained and released the same way RDMutableValue does it
+    template<typename T>
+    bool set(RDMutableValue *_Nullable value, const char *_Nullable field, const T &newValue) {
+        static_assert(detail::is_storable_v<T>, "T must be trivially copyable or an object pointer");
+        if (T *slot = detail::locate<T>(value, field); slot != nullptr)
+            return *slot = newValue, true;
+        return false;
+    }
+
+    template<typename Signature>
+    struct invoker;
+
+    template<typename R, typename ... Args>
+    struct invoker<R(Args...)> {
+        static R invoke(id _Nullable target, SEL selector, Args ... args) {
+            static thread_local detail::method_cache<R, Args...> cache;
+            if (target == nil)
+                return R();
+
+            Method method = cache.lookup(object_getClass(target), selector);
+            if (method == NULL)
+                @throw [NSException exceptionWithName:@"InvocationFailedException"
+                                               reason:[NSString stringWithFormat:@"Signature does not match -[%@ %s]",
+                                                       object_getClass(target), sel_getName(selector)]
+                                             userInfo:nil];
+
+            return reinterpret_cast<R (*)(id, SEL, Args...)>(method_getImplementation(method))(target, selector, args...);
+        }
+    };
+
+    // Throws the same exception as -[RDInvocation invokeWithTarget:selector:] when the signature does not match
+    template<typename Signature, typename ... Args>
+    auto invoke(id _Nullable target, SEL selector, Args && ... args) {
+        return invoker<Signature>::invoke(target, selector, std::forward<Args>(args)...);
+    }
+
+}
+
+NS_ASSUME_NONNULL_END
+
+#endif
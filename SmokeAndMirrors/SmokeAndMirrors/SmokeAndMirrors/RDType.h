@@ -117,6 +117,21 @@ typedef NS_ENUM(char, RDPropertyAttributeKind) {
 
 RD_EXTERN NSArray<NSNumber *> *RDAllPropertyAttributeKinds(void);
 
+// Bit i is set when the attribute at index i of RDAllPropertyAttributeKinds() is present
+typedef NS_OPTIONS(uint16_t, RDPropertyAttributeFlags) {
+    RDPropertyAttributeFlagReadOnly         = (1 << 0),
+    RDPropertyAttributeFlagCopy             = (1 << 1),
+    RDPropertyAttributeFlagRetain           = (1 << 2),
+    RDPropertyAttributeFlagNonatomic        = (1 << 3),
+    RDPropertyAttributeFlagGetter           = (1 << 4),
+    RDPropertyAttributeFlagSetter           = (1 << 5),
+    RDPropertyAttributeFlagDynamic          = (1 << 6),
+    RDPropertyAttributeFlagWeak             = (1 << 7),
+    RDPropertyAttributeFlagGarbageCollected = (1 << 8),
+    RDPropertyAttributeFlagLegacyEncoding   = (1 << 9),
+    RDPropertyAttributeFlagIvarName         = (1 << 10),
+};
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 @interface RDType : NSObject<NSSecureCoding>
@@ -242,6 +257,10 @@ RD_FINAL_CLASS
 @property (nonatomic, readonly, nullable) RDType *type;
 @property (nonatomic, readonly) NSUInteger attributesCount;
 @property (nonatomic, readonly) const char *objcTypeEncoding;
+@property (nonatomic, readonly) RDPropertyAttributeFlags flags;
+// Interned selectors of the G and S attributes; NULL when the default accessors are used
+@property (nonatomic, readonly, nullable) SEL getter;
+@property (nonatomic, readonly, nullable) SEL setter;
 
 + (nullable instancetype)signatureWithObjcTypeEncoding:(const char *)encoding;
 - (nullable RDPropertyAttribute *)attributeWithKind:(RDPropertyAttributeKind)kind;
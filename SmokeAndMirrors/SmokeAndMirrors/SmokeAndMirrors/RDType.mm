@@ -11,9 +11,6 @@ RDTypeSize const RDTypeSizeUnknown = (size_t)0 - 1;
 RDTypeAlign const RDTypeAlignUnknown = (size_t)0 - 1;
 RDOffset const RDOffsetUnknown = (size_t)0 -1;
 
-static size_t parseCountSucceded = 0;
-static size_t parseCountFailed = 0;
-
 RDType *parseType(const char *_Nonnull *_Nonnull encoding);
 RDMethodSignature *parseMethodSignature(const char *_Nonnull *_Nonnull encoding);
 RDPropertySignature *parsePropertySignature(const char *_Nonnull *_Nonnull encoding);
@@ -25,15 +22,18 @@ BOOL areEqual(_Nullable id lhs, _Nullable id rhs) {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// Encodings handed in by callers are expected to fail now and then, so only counting is done for them
 template<typename T>
-T *parseCheck(T *(*parser)(const char **), const char *_Nonnull *_Nonnull encoding) {
+T *parseCheck(T *(*parser)(const char **), const char *_Nonnull *_Nonnull encoding, bool report = true) {
+    RD_METRICS_TIME(RDMetricsTimerTypeParse);
     const char *e = *encoding;
     T *result = parser(encoding);
     if (result == nil) {
-        NSLog(@"%p: %s___------->___%s", parser, e, *encoding);
-        parseCountFailed += 1;
+        RDMetricsIncrement(RDMetricsCounterTypeParseFailed);
+        if (report)
+            RDMetricsReportParseFailure(e, *encoding);
     } else {
-        parseCountSucceded += 1;
+        RDMetricsIncrement(RDMetricsCounterTypeParseSucceeded);
     }
     return result;
 }
@@ -47,7 +47,7 @@ T *parseCheck(T *(*parser)(const char **), const char *_Nonnull *_Nonnull encodi
         return nil;
     
     const char *it = encoding;
-    RDType *type = parseType(&it);
+    RDType *type = parseCheck(parseType, &it, false);
 
     const char *clonedEncoding = cloneCString(encoding, it - encoding);
     
@@ -809,6 +809,24 @@ BOOL RDFieldsEqual(RDField *lhs, RDField *rhs) {
 
 static NSUInteger const RDPropertyAttributeKindCount = 11;
 
+// Position in RDAllPropertyAttributeKinds(), without going through NSNumber
+static inline NSInteger propertyAttributeIndex(RDPropertyAttributeKind kind) {
+    switch (kind) {
+        case RDPropertyAttributeKindReadOnly: return 0;
+        case RDPropertyAttributeKindCopy: return 1;
+        case RDPropertyAttributeKindRetain: return 2;
+        case RDPropertyAttributeKindNonatomic: return 3;
+        case RDPropertyAttributeKindGetter: return 4;
+        case RDPropertyAttributeKindSetter: return 5;
+        case RDPropertyAttributeKindDynamic: return 6;
+        case RDPropertyAttributeKindWeak: return 7;
+        case RDPropertyAttributeKindGarbageCollected: return 8;
+        case RDPropertyAttributeKindLegacyEncoding: return 9;
+        case RDPropertyAttributeKindIvarName: return 10;
+        default: return -1;
+    }
+}
+
 @implementation RDPropertySignature {
     RDPropertyAttribute _attributes[RDPropertyAttributeKindCount];
 }
@@ -823,27 +841,53 @@ static NSUInteger const RDPropertyAttributeKindCount = 11;
 }
 
 + (instancetype)signatureWithObjcTypeEncoding:(const char *)encoding {
-    if (encoding != nil && *encoding != '\0')
-        return parseCheck(parsePropertySignature, &encoding);
-    else
+    if (encoding == nil || *encoding == '\0')
         return nil;
+
+    const char *it = encoding;
+    RDPropertySignature *signature = parseCheck(parsePropertySignature, &it);
+    if (signature != nil && signature->_objcTypeEncoding == NULL)
+        signature->_objcTypeEncoding = cloneCString(encoding, it - encoding);
+    return signature;
 }
 
 - (instancetype)initWithType:(RDType *)type attributes:(RDPropertyAttribute *)attributes count:(NSUInteger)count {
     self = [super init];
     if (self) {
         _type = type;
-        for (NSUInteger i = 0; i < count; ++i)
-            if (NSUInteger index = [RDAllPropertyAttributeKinds() indexOfObject:@(attributes[i].kind)]; index != NSNotFound)
-                _attributes[index] = attributes[i];
+        for (NSUInteger i = 0; i < count; ++i) {
+            NSInteger index = propertyAttributeIndex(attributes[i].kind);
+            if (index < 0)
+                continue;
+
+            _attributes[index] = attributes[i];
+            _flags |= 1 << index;
+            switch (attributes[i].kind) {
+                case RDPropertyAttributeKindGetter:
+                    _getter = sel_registerName(attributes[i].value.UTF8String);
+                    break;
+                case RDPropertyAttributeKindSetter:
+                    _setter = sel_registerName(attributes[i].value.UTF8String);
+                    break;
+                case RDPropertyAttributeKindIvarName:
+                    _ivarName = attributes[i].value;
+                    break;
+                default:
+                    break;
+            }
+        }
+        _attributesCount = __builtin_popcount(_flags);
     }
     return self;
 }
 
+- (void)dealloc {
+    free((void *)_objcTypeEncoding);
+}
+
 - (RDPropertyAttribute *)attributeWithKind:(RDPropertyAttributeKind)kind {
-    if (NSUInteger index = [RDAllPropertyAttributeKinds() indexOfObject:@(kind)]; index != NSNotFound)
-        if (RDPropertyAttribute *attribute = &_attributes[index]; attribute->kind != 0)
-            return attribute;
+    if (NSInteger index = propertyAttributeIndex(kind); index >= 0 && (_flags & (1 << index)) != 0)
+        return &_attributes[index];
 
     return NULL;
 }
@@ -0,0 +1,65 @@
+#import <Foundation/Foundation.h>
+#import "RDCommon.h"
+#import "RDType.h"
+#import "RDValue.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+RD_EXTERN NSErrorDomain const RDTypeConverterErrorDomain;
+RD_EXTERN NSInteger const RDTypeConverterUnknownSizeErrorCode;
+
+typedef NS_OPTIONS(NSUInteger, RDTypeConverterOptions) {
+    RDTypeConverterOptionsNone              = 0,
+    // Struct fields are matched by name rather than by position
+    RDTypeConverterMatchFieldsByName        = (1 << 0),
+};
+
+typedef NS_ENUM(NSUInteger, RDTypeConversionIssueKind) {
+    // Not every source value is representable: narrowing, sign changes, floating point to integer and so on
+    RDTypeConversionIssueKindLossy,
+    // Destination field or element without a source; it is zeroed
+    RDTypeConversionIssueKindUnmappedDestination,
+    // Source field or element that is not read
+    RDTypeConversionIssueKindUnmappedSource,
+    // Matched, but there is no conversion between the two types; the destination is zeroed
+    RDTypeConversionIssueKindIncompatible,
+};
+
+RD_FINAL_CLASS
+@interface RDTypeConversionIssue : NSObject
+
+@property (nonatomic, readonly) RDTypeConversionIssueKind kind;
+// Dotted field names and [index] subscripts, relative to the destination type unless the source field is unmapped
+@property (nonatomic, readonly) NSString *path;
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+// A conversion program compiled once for a pair of types and run over buffers of any number of elements.
+// Numbers are widened and narrowed as in C, except that floating point to integer conversions saturate
+// and NaN becomes zero. Objects must match the same way isAssignableFromType: requires.
+RD_FINAL_CLASS
+@interface RDTypeConverter : NSObject
+
+@property (nonatomic, readonly) RDType *sourceType;
+@property (nonatomic, readonly) RDType *destinationType;
+@property (nonatomic, readonly) NSArray<RDTypeConversionIssue *> *issues;
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
++ (nullable instancetype)converterFromType:(RDType *)sourceType
+                                    toType:(RDType *)destinationType
+                                   options:(RDTypeConverterOptions)options
+                                     error:(NSError *_Nullable *_Nullable)error;
+
+// Elements are laid out with their type's size as the stride. The buffers must not overlap. Destination elements
+// must be initialized; object fields in them are released before being overwritten, the way RDMutableValue does it.
+- (void)convertBytes:(const void *)source toBytes:(void *)destination count:(NSUInteger)count;
+- (nullable RDValue *)convertValue:(RDValue *)value;
+
+@end
+
+NS_ASSUME_NONNULL_END
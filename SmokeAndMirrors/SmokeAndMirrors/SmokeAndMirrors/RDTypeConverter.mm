@@ -0,0 +1,478 @@
+#import "RDTypeConverter.h"
+#import "RDPrivate.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+NSErrorDomain const RDTypeConverterErrorDomain = @"RDTypeConverterErrorDomain";
+NSInteger const RDTypeConverterUnknownSizeErrorCode = 1;
+
+#define ECODE(CODE) (void)(error != NULL && (*error = [NSError errorWithDomain:RDTypeConverterErrorDomain code:(CODE) userInfo:nil])), nil
+
+typedef void (*RDConverterKernel)(uint8_t *destination, size_t destinationStride,
+                                  const uint8_t *source, size_t sourceStride, size_t count);
+
+template<typename T>
+struct RDConverterTag {
+    using type = T;
+};
+
+template<typename F>
+static bool RDConverterWithNumericType(RDPrimitiveTypeKind kind, F &&body) {
+    switch (kind) {
+        case RDPrimitiveTypeKindChar:
+            return body(RDConverterTag<signed char>()), true;
+        case RDPrimitiveTypeKindUnsignedChar:
+            return body(RDConverterTag<unsigned char>()), true;
+        case RDPrimitiveTypeKindBool:
+            return body(RDConverterTag<bool>()), true;
+        case RDPrimitiveTypeKindShort:
+            return body(RDConverterTag<short>()), true;
+        case RDPrimitiveTypeKindUnsignedShort:
+            return body(RDConverterTag<unsigned short>()), true;
+        case RDPrimitiveTypeKindInt:
+            return body(RDConverterTag<int>()), true;
+        case RDPrimitiveTypeKindUnsignedInt:
+            return body(RDConverterTag<unsigned int>()), true;
+        case RDPrimitiveTypeKindLong:
+            return body(RDConverterTag<long>()), true;
+        case RDPrimitiveTypeKindUnsignedLong:
+            return body(RDConverterTag<unsigned long>()), true;
+        case RDPrimitiveTypeKindLongLong:
+            return body(RDConverterTag<long long>()), true;
+        case RDPrimitiveTypeKindUnsignedLongLong:
+            return body(RDConverterTag<unsigned long long>()), true;
+        case RDPrimitiveTypeKindFloat:
+            return body(RDConverterTag<float>()), true;
+        case RDPrimitiveTypeKindDouble:
+            return body(RDConverterTag<double>()), true;
+        default:
+            return false;
+    }
+}
+
+template<typename D, typename S>
+static constexpr bool RDConverterIsLossy() {
+    using SL = std::numeric_limits<S>;
+    using DL = std::numeric_limits<D>;
+    if constexpr (std::is_same_v<D, S> || std::is_same_v<S, bool>)
+        return false;
+    else if constexpr (std::is_same_v<D, bool> || (std::is_floating_point_v<S> && !std::is_floating_point_v<D>))
+        return true;
+    else if constexpr (std::is_floating_point_v<D>)
+        return SL::digits > DL::digits;
+    else
+        return (SL::is_signed && !DL::is_signed) || SL::digits > DL::digits;
+}
+
+template<typename D, typename S>
+static inline D RDConverterConvertNumber(S value) {
+    if constexpr (std::is_same_v<D, bool>) {
+        return value != 0;
+    } else if constexpr (std::is_floating_point_v<S> && !std::is_floating_point_v<D>) {
+        // Out of range conversions are undefined in C; saturate instead
+        if (value != value)
+            return 0;
+        if (value <= (S)std::numeric_limits<D>::min())
+            return std::numeric_limits<D>::min();
+        if (value >= (S)std::numeric_limits<D>::max())
+            return std::numeric_limits<D>::max();
+        return (D)value;
+    } else {
+        return (D)value;
+    }
+}
+
+template<typename D, typename S>
+__attribute__((always_inline)) static inline void RDConverterLoop(uint8_t *__restrict destination, size_t destinationStride,
+                                                                 const uint8_t *__restrict source, size_t sourceStride, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        S value;
+        memcpy(&value, source + i * sourceStride, sizeof(S));
+        D result = RDConverterConvertNumber<D, S>(value);
+        memcpy(destination + i * destinationStride, &result, sizeof(D));
+    }
+}
+
+template<typename D, typename S>
+static void RDConverterConvert(uint8_t *destination, size_t destinationStride, const uint8_t *source, size_t sourceStride, size_t count) {
+    // Constant strides let the loop be vectorized for plain arrays of numbers
+    if (destinationStride == sizeof(D) && sourceStride == sizeof(S))
+        RDConverterLoop<D, S>(destination, sizeof(D), source, sizeof(S), count);
+    else
+        RDConverterLoop<D, S>(destination, destinationStride, source, sourceStride, count);
+}
+
+struct RDConverterNumeric {
+    RDConverterKernel kernel;
+    bool lossy;
+};
+
+static std::optional<RDConverterNumeric> RDConverterNumericConversion(RDPrimitiveTypeKind destination, RDPrimitiveTypeKind source) {
+    std::optional<RDConverterNumeric> result;
+    RDConverterWithNumericType(destination, [&](auto d) {
+        RDConverterWithNumericType(source, [&](auto s) {
+            using D = typename decltype(d)::type;
+            using S = typename decltype(s)::type;
+            result = RDConverterNumeric { &RDConverterConvert<D, S>, RDConverterIsLossy<D, S>() };
+        });
+    });
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct RDConverterOp {
+    enum Kind : uint8_t {
+        Copy,
+        Convert,
+        Object,
+        ClearObject,
+        Zero,
+    };
+
+    Kind kind;
+    uint32_t destination;
+    uint32_t source;
+    uint32_t size;
+    RDConverterKernel kernel = nullptr;
+    // Convert ops of arrays of numbers run once per element of the array
+    uint32_t repeat = 1;
+    uint32_t destinationStep = 0;
+    uint32_t sourceStep = 0;
+};
+
+@interface RDTypeConversionIssue ()
+
+- (instancetype)initWithKind:(RDTypeConversionIssueKind)kind path:(NSString *)path;
+
+@end
+
+static RDType *RDConverterUnwrap(RDType *type) {
+    while (RDCompositeType *composite = RD_CAST(type, RDCompositeType)) {
+        if (composite.kind != RDCompositeTypeKindConst && composite.kind != RDCompositeTypeKindAtomic)
+            break;
+        type = composite.type;
+    }
+    return type;
+}
+
+static NSString *RDConverterPath(NSString *path, NSString *_Nullable name, NSUInteger index) {
+    NSString *component = name ?: [NSString stringWithFormat:@"%lu", (unsigned long)index];
+    return path.length == 0 ? component : [NSString stringWithFormat:@"%@.%@", path, component];
+}
+
+class RDConverterCompiler {
+public:
+    std::vector<RDConverterOp> ops;
+    NSMutableArray<RDTypeConversionIssue *> *issues = [NSMutableArray array];
+
+    explicit RDConverterCompiler(RDTypeConverterOptions options) : _options(options) {}
+
+    void compile(RDType *destinationType, uint32_t destination, RDType *sourceType, uint32_t source, NSString *path) {
+        destinationType = RDConverterUnwrap(destinationType);
+        sourceType = RDConverterUnwrap(sourceType);
+
+        if (RD_CAST(destinationType, RDBitfieldType) || RD_CAST(sourceType, RDBitfieldType)) {
+            // Bitfields share their bytes with neighbours, so they are neither copied nor cleared
+            issue(RDTypeConversionIssueKindUnmappedDestination, path);
+            _skipped = true;
+            return;
+        }
+
+        if (RD_CAST(destinationType, RDObjectType)) {
+            if (RD_CAST(sourceType, RDObjectType) && [destinationType isAssignableFromType:sourceType])
+                push({ RDConverterOp::Object, destination, source, sizeof(id) });
+            else
+                incompatible(destinationType, destination, path);
+            return;
+        }
+
+        RDAggregateType *destinationAggregate = RD_CAST(destinationType, RDAggregateType);
+        RDAggregateType *sourceAggregate = RD_CAST(sourceType, RDAggregateType);
+        if (destinationAggregate.kind == RDAggregateTypeKindStruct && sourceAggregate.kind == RDAggregateTypeKindStruct)
+            return compileStruct(destinationAggregate, destination, sourceAggregate, source, path);
+
+        RDArrayType *destinationArray = RD_CAST(destinationType, RDArrayType);
+        RDArrayType *sourceArray = RD_CAST(sourceType, RDArrayType);
+        if (destinationArray != nil && sourceArray != nil)
+            return compileArray(destinationArray, destination, sourceArray, source, path);
+
+        RDPrimitiveType *destinationPrimitive = RD_CAST(destinationType, RDPrimitiveType);
+        RDPrimitiveType *sourcePrimitive = RD_CAST(sourceType, RDPrimitiveType);
+        if (destinationPrimitive != nil && sourcePrimitive != nil && destinationPrimitive.kind != sourcePrimitive.kind) {
+            if (auto numeric = RDConverterNumericConversion(destinationPrimitive.kind, sourcePrimitive.kind)) {
+                if (numeric->lossy)
+                    issue(RDTypeConversionIssueKindLossy, path);
+                push({ RDConverterOp::Convert, destination, source, 0, numeric->kernel });
+                return;
+            }
+        }
+
+        if ([destinationType isAssignableFromType:sourceType] && [sourceType isAssignableFromType:destinationType]
+            && destinationType.size == sourceType.size && destinationType.size != RDTypeSizeUnknown)
+            push({ RDConverterOp::Copy, destination, source, (uint32_t)destinationType.size });
+        else
+            incompatible(destinationType, destination, path);
+    }
+
+    // Ops are merged where possible; equal gaps on both sides are padding, which is fine to copy along,
+    // unless bytes that must be left alone were skipped in between
+    void push(const RDConverterOp &op) {
+        bool skipped = std::exchange(_skipped, false);
+        if (!ops.empty()) {
+            RDConverterOp &last = ops.back();
+            if (op.kind == RDConverterOp::Copy && last.kind == RDConverterOp::Copy && !skipped
+                && op.destination >= last.destination + last.size && op.destination - last.destination == op.source - last.source) {
+                last.size = op.destination + op.size - last.destination;
+                return;
+            }
+            if (op.kind == RDConverterOp::Zero && last.kind == RDConverterOp::Zero && op.destination == last.destination + last.size) {
+                last.size += op.size;
+                return;
+            }
+        }
+        ops.push_back(op);
+    }
+
+    void clear(RDType *type, uint32_t destination) {
+        type = RDConverterUnwrap(type);
+        if (RD_CAST(type, RDBitfieldType) || type.size == RDTypeSizeUnknown)
+            return (void)(_skipped = true);
+
+        if (RD_CAST(type, RDObjectType))
+            return push({ RDConverterOp::ClearObject, destination, 0, sizeof(id) });
+
+        if (RDAggregateType *aggregate = RD_CAST(type, RDAggregateType); aggregate.kind == RDAggregateTypeKindStruct) {
+            for (NSUInteger i = 0; i < aggregate.count; ++i)
+                if (RDField *field = [aggregate fieldAtIndex:i])
+                    clear(field->type, destination + (uint32_t)field->offset);
+            return;
+        }
+
+        if (RDArrayType *array = RD_CAST(type, RDArrayType); array.type != nil) {
+            for (NSUInteger i = 0; i < array.count; ++i)
+                clear(array.type, destination + (uint32_t)[array offsetForElementAtIndex:i]);
+            return;
+        }
+
+        push({ RDConverterOp::Zero, destination, 0, (uint32_t)type.size });
+    }
+
+private:
+    RDTypeConverterOptions _options;
+    NSUInteger _quiet = 0;
+    // Set when destination bytes were left untouched since the last op, so that no copy is merged across them
+    bool _skipped = false;
+
+    void issue(RDTypeConversionIssueKind kind, NSString *path) {
+        if (_quiet == 0)
+            [issues addObject:[[RDTypeConversionIssue alloc] initWithKind:kind path:path]];
+    }
+
+    void incompatible(RDType *destinationType, uint32_t destination, NSString *path) {
+        issue(RDTypeConversionIssueKindIncompatible, path);
+        clear(destinationType, destination);
+    }
+
+    void compileStruct(RDAggregateType *destinationType, uint32_t destination, RDAggregateType *sourceType, uint32_t source, NSString *path) {
+        std::vector<bool> used(sourceType.count, false);
+        for (NSUInteger i = 0; i < destinationType.count; ++i) {
+            RDField *field = [destinationType fieldAtIndex:i];
+            NSString *fieldPath = RDConverterPath(path, field->name, i);
+
+            NSUInteger match = NSNotFound;
+            if (!(_options & RDTypeConverterMatchFieldsByName))
+                match = i < sourceType.count ? i : NSNotFound;
+            else if (field->name != nil)
+                for (NSUInteger j = 0; j < sourceType.count && match == NSNotFound; ++j)
+                    if ([[sourceType fieldAtIndex:j]->name isEqualToString:field->name])
+                        match = j;
+
+            if (match == NSNotFound) {
+                issue(RDTypeConversionIssueKindUnmappedDestination, fieldPath);
+                clear(field->type, destination + (uint32_t)field->offset);
+                continue;
+            }
+
+            used[match] = true;
+            RDField *sourceField = [sourceType fieldAtIndex:match];
+            compile(field->type, destination + (uint32_t)field->offset, sourceField->type, source + (uint32_t)sourceField->offset, fieldPath);
+        }
+
+        for (NSUInteger j = 0; j < sourceType.count; ++j)
+            if (!used[j])
+                issue(RDTypeConversionIssueKindUnmappedSource, RDConverterPath(path, [sourceType fieldAtIndex:j]->name, j));
+    }
+
+    void compileArray(RDArrayType *destinationType, uint32_t destination, RDArrayType *sourceType, uint32_t source, NSString *path) {
+        NSString *elementPath = [path stringByAppendingString:@"[]"];
+        NSUInteger count = MIN(destinationType.count, sourceType.count);
+        if (destinationType.type == nil || sourceType.type == nil)
+            return incompatible(destinationType, destination, path);
+
+        // A lone conversion per element becomes a single strided op rather than count of them;
+        // an element that is itself strided, like a row of a nested array, is compiled row by row instead
+        RDConverterCompiler element(_options);
+        element.compile(destinationType.type, 0, sourceType.type, 0, elementPath);
+        if (count > 1 && element.ops.size() == 1 && element.ops[0].kind == RDConverterOp::Convert && element.ops[0].repeat == 1) {
+            if (_quiet == 0)
+                [issues addObjectsFromArray:element.issues];
+            RDConverterOp op = element.ops[0];
+            op.destination += destination;
+            op.source += source;
+            op.repeat = (uint32_t)count;
+            op.destinationStep = (uint32_t)[destinationType offsetForElementAtIndex:1];
+            op.sourceStep = (uint32_t)[sourceType offsetForElementAtIndex:1];
+            push(op);
+        } else {
+            // Every element reports the same issues, so only the first one does
+            for (NSUInteger i = 0; i < count; ++i, ++_quiet)
+                compile(destinationType.type, destination + (uint32_t)[destinationType offsetForElementAtIndex:i],
+                        sourceType.type, source + (uint32_t)[sourceType offsetForElementAtIndex:i], elementPath);
+            _quiet -= count;
+        }
+
+        if (destinationType.count > count) {
+            issue(RDTypeConversionIssueKindUnmappedDestination,
+                  [path stringByAppendingFormat:@"[%lu...%lu]", (unsigned long)count, (unsigned long)destinationType.count - 1]);
+            for (NSUInteger i = count; i < destinationType.count; ++i)
+                clear(destinationType.type, destination + (uint32_t)[destinationType offsetForElementAtIndex:i]);
+        }
+
+        if (sourceType.count > count)
+            issue(RDTypeConversionIssueKindUnmappedSource,
+                  [path stringByAppendingFormat:@"[%lu...%lu]", (unsigned long)count, (unsigned long)sourceType.count - 1]);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@implementation RDTypeConversionIssue
+
+- (instancetype)initWithKind:(RDTypeConversionIssueKind)kind path:(NSString *)path {
+    self = [super init];
+    if (self) {
+        _kind = kind;
+        _path = [path copy];
+    }
+    return self;
+}
+
+- (NSString *)description {
+    static NSString *const kinds[] = {
+        [RDTypeConversionIssueKindLossy] = @"lossy",
+        [RDTypeConversionIssueKindUnmappedDestination] = @"unmapped destination",
+        [RDTypeConversionIssueKindUnmappedSource] = @"unmapped source",
+        [RDTypeConversionIssueKindIncompatible] = @"incompatible",
+    };
+    return [NSString stringWithFormat:@"%@: %@", kinds[self.kind], self.path.length > 0 ? self.path : @"<value>"];
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@implementation RDTypeConverter {
+    std::vector<RDConverterOp> _ops;
+    size_t _sourceSize;
+    size_t _destinationSize;
+}
+
++ (instancetype)converterFromType:(RDType *)sourceType
+                           toType:(RDType *)destinationType
+                          options:(RDTypeConverterOptions)options
+                            error:(NSError **)error
+{
+    if (sourceType.size == RDTypeSizeUnknown || sourceType.size == 0
+        || destinationType.size == RDTypeSizeUnknown || destinationType.size == 0)
+        return ECODE(RDTypeConverterUnknownSizeErrorCode);
+
+    RDConverterCompiler compiler(options);
+    compiler.compile(destinationType, 0, sourceType, 0, @"");
+    return [[self alloc] initWithSourceType:sourceType destinationType:destinationType ops:std::move(compiler.ops) issues:compiler.issues];
+}
+
+- (instancetype)initWithSourceType:(RDType *)sourceType
+                   destinationType:(RDType *)destinationType
+                               ops:(std::vector<RDConverterOp>)ops
+                            issues:(NSArray<RDTypeConversionIssue *> *)issues
+{
+    self = [super init];
+    if (self) {
+        _sourceType = sourceType;
+        _destinationType = destinationType;
+        _issues = [issues copy];
+        _ops = std::move(ops);
+        _sourceSize = sourceType.size;
+        _destinationSize = destinationType.size;
+    }
+    return self;
+}
+
+static void RDConverterRun(const RDConverterOp &op, uint8_t *destination, size_t destinationStride,
+                           const uint8_t *source, size_t sourceStride, size_t count)
+{
+    switch (op.kind) {
+        case RDConverterOp::Copy:
+            for (size_t i = 0; i < count; ++i)
+                memcpy(destination + i * destinationStride + op.destination, source + i * sourceStride + op.source, op.size);
+            break;
+        case RDConverterOp::Convert:
+            if (count == 1)
+                op.kernel(destination + op.destination, op.destinationStep, source + op.source, op.sourceStep, op.repeat);
+            else
+                for (uint32_t k = 0; k < op.repeat; ++k)
+                    op.kernel(destination + op.destination + k * op.destinationStep, destinationStride,
+                              source + op.source + k * op.sourceStep, sourceStride, count);
+            break;
+        case RDConverterOp::Object:
+            for (size_t i = 0; i < count; ++i)
+                objc_storeStrong((__autoreleasing id *)(void *)(destination + i * destinationStride + op.destination),
+                                 (__bridge id)*(void *const *)(source + i * sourceStride + op.source));
+            break;
+        case RDConverterOp::ClearObject:
+            for (size_t i = 0; i < count; ++i)
+                objc_storeStrong((__autoreleasing id *)(void *)(destination + i * destinationStride + op.destination), nil);
+            break;
+        case RDConverterOp::Zero:
+            for (size_t i = 0; i < count; ++i)
+                memset(destination + i * destinationStride + op.destination, 0, op.size);
+            break;
+    }
+}
+
+- (void)convertBytes:(const void *)source toBytes:(void *)destination count:(NSUInteger)count {
+    // Identical layouts come down to a single copy op spanning the whole type
+    if (_ops.size() == 1 && _ops[0].kind == RDConverterOp::Copy && _ops[0].size == _sourceSize && _sourceSize == _destinationSize)
+        return (void)memcpy(destination, source, _sourceSize * count);
+
+    // Op by op over blocks of elements, so that dispatch is paid per block and each inner loop is tight
+    static constexpr NSUInteger blockSize = 256;
+    for (NSUInteger start = 0; start < count; start += blockSize) {
+        NSUInteger length = MIN(blockSize, count - start);
+        uint8_t *destinationBlock = (uint8_t *)destination + start * _destinationSize;
+        const uint8_t *sourceBlock = (const uint8_t *)source + start * _sourceSize;
+        for (const RDConverterOp &op : _ops)
+            RDConverterRun(op, destinationBlock, _destinationSize, sourceBlock, _sourceSize, length);
+    }
+}
+
+- (RDValue *)convertValue:(RDValue *)value {
+    RDType *type = nil;
+    const uint8_t *bytes = [value bufferType:&type];
+    if (bytes == NULL || ![type isEqualToType:_sourceType])
+        return nil;
+
+    RDMutableValue *result = [RDMutableValue valueWithBytes:NULL ofType:_destinationType];
+    [self convertBytes:bytes toBytes:[result bufferType:NULL] count:1];
+    return [result copy];
+}
+
+@end
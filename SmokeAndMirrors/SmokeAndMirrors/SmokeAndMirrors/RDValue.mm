@@ -1,7 +1,6 @@
 #import "RDValue.h"
 #import "RDPrivate.h"
 
-#import <malloc/malloc.h>
 #import <objc/runtime.h>
 #import <cstdarg>
 
@@ -0,0 +1,50 @@
+#import <Foundation/Foundation.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+NS_ASSUME_NONNULL_BEGIN
+
+template<typename T>
+static inline void RDBenchmarkDoNotOptimize(T const &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct RDBenchmarkOptions {
+    NSUInteger samples = 30;
+    NSUInteger warmupSamples = 3;
+    double minimumSampleNanoseconds = 5e6;
+    std::string filter;
+};
+
+struct RDBenchmarkSummary {
+    double min, max, mean, median, p90, p99, stddev, mad;
+};
+
+struct RDBenchmarkResult {
+    std::string name;
+    NSUInteger operationsPerIteration;
+    NSUInteger iterationsPerSample;
+    std::vector<double> nanosecondsPerOperation;
+
+    RDBenchmarkSummary summary() const;
+};
+
+// Runs bodies in calibrated batches: each sample repeats the body until it covers minimumSampleNanoseconds
+class RDBenchmarkRunner {
+public:
+    explicit RDBenchmarkRunner(RDBenchmarkOptions options) : _options(std::move(options)) {}
+
+    void run(const std::string &name, NSUInteger operationsPerIteration, const std::function<void()> &body);
+    void run(const std::string &name, NSUInteger operationsPerIteration, NSUInteger samples, const std::function<void()> &body);
+
+    const std::vector<RDBenchmarkResult> &results() const { return _results; }
+    NSDictionary<NSString *, id> *jsonObject(NSDictionary<NSString *, id> *_Nullable extra) const;
+
+private:
+    RDBenchmarkOptions _options;
+    std::vector<RDBenchmarkResult> _results;
+};
+
+NS_ASSUME_NONNULL_END
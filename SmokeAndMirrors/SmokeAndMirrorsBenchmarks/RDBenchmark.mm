@@ -0,0 +1,127 @@
+#import "RDBenchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+static double RDBenchmarkPercentile(const std::vector<double> &sorted, double percentile) {
+    if (sorted.empty())
+        return NAN;
+
+    double position = percentile * (sorted.size() - 1);
+    size_t lower = (size_t)std::floor(position);
+    size_t upper = std::min(lower + 1, sorted.size() - 1);
+    return sorted[lower] + (sorted[upper] - sorted[lower]) * (position - lower);
+}
+
+RDBenchmarkSummary RDBenchmarkResult::summary() const {
+    std::vector<double> sorted = nanosecondsPerOperation;
+    std::sort(sorted.begin(), sorted.end());
+    if (sorted.empty())
+        return { NAN, NAN, NAN, NAN, NAN, NAN, NAN, NAN };
+
+    double sum = 0;
+    for (double sample : sorted)
+        sum += sample;
+    double mean = sum / sorted.size();
+
+    double squares = 0;
+    for (double sample : sorted)
+        squares += (sample - mean) * (sample - mean);
+    double stddev = sorted.size() > 1 ? std::sqrt(squares / (sorted.size() - 1)) : 0;
+
+    double median = RDBenchmarkPercentile(sorted, 0.5);
+    std::vector<double> deviations;
+    deviations.reserve(sorted.size());
+    for (double sample : sorted)
+        deviations.push_back(std::fabs(sample - median));
+    std::sort(deviations.begin(), deviations.end());
+
+    return {
+        .min = sorted.front(),
+        .max = sorted.back(),
+        .mean = mean,
+        .median = median,
+        .p90 = RDBenchmarkPercentile(sorted, 0.9),
+        .p99 = RDBenchmarkPercentile(sorted, 0.99),
+        .stddev = stddev,
+        .mad = RDBenchmarkPercentile(deviations, 0.5),
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static double RDBenchmarkMeasure(NSUInteger iterations, const std::function<void()> &body) {
+    auto start = std::chrono::steady_clock::now();
+    for (NSUInteger i = 0; i < iterations; ++i)
+        @autoreleasepool {
+            body();
+        }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+}
+
+void RDBenchmarkRunner::run(const std::string &name, NSUInteger operationsPerIteration, const std::function<void()> &body) {
+    run(name, operationsPerIteration, _options.samples, body);
+}
+
+void RDBenchmarkRunner::run(const std::string &name, NSUInteger operationsPerIteration, NSUInteger samples, const std::function<void()> &body) {
+    if (!_options.filter.empty() && name.find(_options.filter) == std::string::npos)
+        return;
+
+    NSUInteger iterations = 1;
+    while (RDBenchmarkMeasure(iterations, body) < _options.minimumSampleNanoseconds && iterations < (1u << 30))
+        iterations *= 2;
+
+    for (NSUInteger i = 0; i < _options.warmupSamples; ++i)
+        RDBenchmarkMeasure(iterations, body);
+
+    RDBenchmarkResult result = { name, MAX(operationsPerIteration, 1u), iterations, {} };
+    result.nanosecondsPerOperation.reserve(samples);
+    for (NSUInteger i = 0; i < samples; ++i)
+        result.nanosecondsPerOperation.push_back(RDBenchmarkMeasure(iterations, body) / (iterations * result.operationsPerIteration));
+
+    RDBenchmarkSummary summary = result.summary();
+    fprintf(stderr, "%-40s %12.1f ns/op (median) ± %.1f (mad), %lu×%lu ops/sample\n",
+            name.c_str(), summary.median, summary.mad, (unsigned long)iterations, (unsigned long)result.operationsPerIteration);
+
+    _results.push_back(std::move(result));
+}
+
+NSDictionary<NSString *, id> *RDBenchmarkRunner::jsonObject(NSDictionary<NSString *, id> *extra) const {
+    NSMutableArray<NSDictionary *> *benchmarks = [NSMutableArray arrayWithCapacity:_results.size()];
+    for (const RDBenchmarkResult &result : _results) {
+        NSMutableArray<NSNumber *> *samples = [NSMutableArray arrayWithCapacity:result.nanosecondsPerOperation.size()];
+        for (double sample : result.nanosecondsPerOperation)
+            [samples addObject:@(sample)];
+
+        RDBenchmarkSummary summary = result.summary();
+        [benchmarks addObject:@{
+            @"name": @(result.name.c_str()),
+            @"unit": @"ns/op",
+            @"operationsPerIteration": @(result.operationsPerIteration),
+            @"iterationsPerSample": @(result.iterationsPerSample),
+            @"summary": @{
+                @"min": @(summary.min),
+                @"max": @(summary.max),
+                @"mean": @(summary.mean),
+                @"median": @(summary.median),
+                @"p90": @(summary.p90),
+                @"p99": @(summary.p99),
+                @"stddev": @(summary.stddev),
+                @"mad": @(summary.mad),
+            },
+            @"samples": samples,
+        }];
+    }
+
+    NSMutableDictionary<NSString *, id> *object = [NSMutableDictionary dictionaryWithDictionary:extra ?: @{}];
+    object[@"options"] = @{
+        @"samples": @(_options.samples),
+        @"warmupSamples": @(_options.warmupSamples),
+        @"minimumSampleNanoseconds": @(_options.minimumSampleNanoseconds),
+        @"filter": @(_options.filter.c_str()),
+    };
+    object[@"benchmarks"] = benchmarks;
+    return object;
+}
@@ -0,0 +1,407 @@
+#import <Foundation/Foundation.h>
+#import <objc/runtime.h>
+#import <objc/message.h>
+#import <SmokeAndMirrors/SmokeAndMirrors.h>
+
+#import "RDBenchmark.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+static NSUInteger const RDBenchmarkBatch = 1000;
+
+typedef struct {
+    double a, b;
+    unsigned long x, y;
+} RDBenchmarkStruct;
+
+@interface RDBenchmarkTarget : RDBlockObject
+@end
+
+@implementation RDBenchmarkTarget
+
++ (SEL)selectorForCalling {
+    return @selector(addValue:);
+}
+
+- (NSUInteger)addValue:(NSUInteger)value {
+    return value + 1;
+}
+
+- (RDBenchmarkStruct)swapFieldsIn:(RDBenchmarkStruct)strct {
+    return (RDBenchmarkStruct){ .a = strct.b, .b = strct.a, .x = strct.y, .y = strct.x };
+}
+
+@end
+
+@interface RDBenchmarkModel : NSObject<NSCopying> {
+@public
+    NSUInteger _identifier;
+    double _score;
+    NSString *_title;
+    NSDate *_created;
+    __weak id _owner;
+    RDBenchmarkStruct _bounds;
+    NSArray *_tags;
+    BOOL _flagged;
+}
+@end
+
+@implementation RDBenchmarkModel
+
+- (id)copyWithZone:(NSZone *)zone {
+    RDBenchmarkModel *copy = [[RDBenchmarkModel allocWithZone:zone] init];
+    copy->_identifier = _identifier;
+    copy->_score = _score;
+    copy->_title = _title;
+    copy->_created = _created;
+    copy->_owner = _owner;
+    copy->_bounds = _bounds;
+    copy->_tags = _tags;
+    copy->_flagged = _flagged;
+    return copy;
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct RDBenchmarkCorpus {
+    std::vector<std::string> types;
+    std::vector<std::string> methods;
+    std::vector<std::string> properties;
+};
+
+static RDBenchmarkCorpus RDBenchmarkHarvestCorpus(void) {
+    RDBenchmarkCorpus corpus;
+    unsigned classCount = 0;
+    Class *classes = objc_copyClassList(&classCount);
+    for (unsigned i = 0; i < classCount; ++i)
+        for (Class cls : { classes[i], object_getClass(classes[i]) }) {
+            unsigned count = 0;
+            if (Ivar *ivars = class_copyIvarList(cls, &count); ivars != NULL) {
+                for (unsigned j = 0; j < count; ++j)
+                    if (const char *encoding = ivar_getTypeEncoding(ivars[j]); encoding != NULL && *encoding != '\0')
+                        corpus.types.emplace_back(encoding);
+                free(ivars);
+            }
+
+            if (Method *methods = class_copyMethodList(cls, &count); methods != NULL) {
+                for (unsigned j = 0; j < count; ++j)
+                    if (const char *encoding = method_getTypeEncoding(methods[j]); encoding != NULL && *encoding != '\0')
+                        corpus.methods.emplace_back(encoding);
+                free(methods);
+            }
+
+            if (objc_property_t *properties = class_copyPropertyList(cls, &count); properties != NULL) {
+                for (unsigned j = 0; j < count; ++j)
+                    if (const char *encoding = property_getAttributes(properties[j]); encoding != NULL && *encoding != '\0')
+                        corpus.properties.emplace_back(encoding);
+                free(properties);
+            }
+        }
+    free(classes);
+
+    // Order of objc_copyClassList depends on image load order; sorting keeps runs comparable between machines
+    for (auto *list : { &corpus.types, &corpus.methods, &corpus.properties }) {
+        std::sort(list->begin(), list->end());
+        list->erase(std::unique(list->begin(), list->end()), list->end());
+    }
+    return corpus;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void RDBenchmarkTypeParsing(RDBenchmarkRunner &runner, const RDBenchmarkCorpus &corpus) {
+    runner.run("parse/type", corpus.types.size(), [&] {
+        for (const std::string &encoding : corpus.types)
+            RDBenchmarkDoNotOptimize((__bridge void *)[RDType typeWithObjcTypeEncoding:encoding.c_str()]);
+    });
+
+    runner.run("parse/methodSignature", corpus.methods.size(), [&] {
+        for (const std::string &encoding : corpus.methods)
+            RDBenchmarkDoNotOptimize((__bridge void *)[RDMethodSignature signatureWithObjcTypeEncoding:encoding.c_str()]);
+    });
+
+    runner.run("parse/propertySignature", corpus.properties.size(), [&] {
+        for (const std::string &encoding : corpus.properties)
+            RDBenchmarkDoNotOptimize((__bridge void *)[RDPropertySignature signatureWithObjcTypeEncoding:encoding.c_str()]);
+    });
+}
+
+static void RDBenchmarkMirroring(RDBenchmarkRunner &runner, NSUInteger samples) {
+    unsigned classCount = 0;
+    Class *classes = objc_copyClassList(&classCount);
+    unsigned protocolCount = 0;
+    Protocol *__unsafe_unretained *protocols = objc_copyProtocolList(&protocolCount);
+
+    runner.run("mirror/classes", classCount, samples, [&] {
+        RDSmoke *smoke = [RDSmoke new];
+        for (unsigned i = 0; i < classCount; ++i) {
+            RDClass *mirror = [smoke mirrorForObjcClass:classes[i]];
+            RDBenchmarkDoNotOptimize((__bridge void *)mirror.ivars);
+            RDBenchmarkDoNotOptimize((__bridge void *)mirror.methods);
+            RDBenchmarkDoNotOptimize((__bridge void *)mirror.properties);
+            RDBenchmarkDoNotOptimize((__bridge void *)mirror.protocols);
+        }
+    });
+
+    runner.run("mirror/protocols", protocolCount, samples, [&] {
+        RDSmoke *smoke = [RDSmoke new];
+        for (unsigned i = 0; i < protocolCount; ++i) {
+            RDProtocol *mirror = [smoke mirrorForObjcProtocol:protocols[i]];
+            RDBenchmarkDoNotOptimize((__bridge void *)mirror.methods);
+            RDBenchmarkDoNotOptimize((__bridge void *)mirror.properties);
+        }
+    });
+
+    RDSmoke *warmSmoke = [RDSmoke new];
+    for (unsigned i = 0; i < classCount; ++i)
+        [warmSmoke mirrorForObjcClass:classes[i]];
+
+    runner.run("mirror/classes/cached", classCount, [&] {
+        for (unsigned i = 0; i < classCount; ++i)
+            RDBenchmarkDoNotOptimize((__bridge void *)[warmSmoke mirrorForObjcClass:classes[i]]);
+    });
+
+    free(protocols);
+    free(classes);
+}
+
+static void RDBenchmarkValues(RDBenchmarkRunner &runner) {
+    RDBenchmarkStruct const sample = { .a = 1, .b = 2, .x = 3, .y = 4 };
+    RDType *type = [RDType typeWithObjcTypeEncoding:@encode(RDBenchmarkStruct)];
+
+    runner.run("value/box", RDBenchmarkBatch, [&] {
+        for (NSUInteger i = 0; i < RDBenchmarkBatch; ++i)
+            RDBenchmarkDoNotOptimize((__bridge void *)RDValueBox(sample));
+    });
+
+    runner.run("value/boxWithType", RDBenchmarkBatch, [&] {
+        for (NSUInteger i = 0; i < RDBenchmarkBatch; ++i)
+            RDBenchmarkDoNotOptimize((__bridge void *)[RDValue valueWithBytes:&sample ofType:type]);
+    });
+
+    RDValue *value = RDValueBox(sample);
+    runner.run("value/get", RDBenchmarkBatch, [&] {
+        RDBenchmarkStruct result;
+        for (NSUInteger i = 0; i < RDBenchmarkBatch; ++i) {
+            RDValueGet(value, &result);
+            RDBenchmarkDoNotOptimize(result);
+        }
+    });
+
+    runner.run("value/getField", RDBenchmarkBatch, [&] {
+        double result;
+        for (NSUInteger i = 0; i < RDBenchmarkBatch; ++i) {
+            RDValueGetAt(value, 1, &result);
+            RDBenchmarkDoNotOptimize(result);
+        }
+    });
+
+    RDMutableValue *mutableValue = [value mutableCopy];
+    runner.run("value/set", RDBenchmarkBatch, [&] {
+        for (NSUInteger i = 0; i < RDBenchmarkBatch; ++i)
+            RDValueSet(mutableValue, sample);
+        RDBenchmarkDoNotOptimize((__bridge void *)mutableValue);
+    });
+
+    runner.run("value/setField", RDBenchmarkBatch, [&] {
+        for (NSUInteger i = 0; i < RDBenchmarkBatch; ++i)
+            RDValueSetAt(mutableValue, 2, (unsigned long)i);
+        RDBenchmarkDoNotOptimize((__bridge void *)mutableValue);
+    });
+
+    runner.run("value/copy", RDBenchmarkBatch, [&] {
+        for (NSUInteger i = 0; i < RDBenchmarkBatch; ++i)
+            RDBenchmarkDoNotOptimize((__bridge void *)[mutableValue copy]);
+    });
+
+    runner.run("value/mutableCopy", RDBenchmarkBatch, [&] {
+        for (NSUInteger i = 0; i < RDBenchmarkBatch; ++i)
+            RDBenchmarkDoNotOptimize((__bridge void *)[value mutableCopy]);
+    });
+}
+
+static void RDBenchmarkInvocations(RDBenchmarkRunner &runner) {
+    RDBenchmarkTarget *target = [RDBenchmarkTarget new];
+
+    runner.run("invoke/objc_msgSend", RDBenchmarkBatch, [&] {
+        NSUInteger (*send)(id, SEL, NSUInteger) = (NSUInteger (*)(id, SEL, NSUInteger))objc_msgSend;
+        for (NSUInteger i = 0; i < RDBenchmarkBatch; ++i)
+            RDBenchmarkDoNotOptimize(send(target, @selector(addValue:), i));
+    });
+
+    RDInvocation *invocation = [RDInvocation invocationWithArguments:RDValueTuple((NSUInteger)42)];
+    runner.run("invoke/RDInvocation", RDBenchmarkBatch, [&] {
+        for (NSUInteger i = 0; i < RDBenchmarkBatch; ++i)
+            RDBenchmarkDoNotOptimize((__bridge void *)[invocation invokeWithTarget:target selector:@selector(addValue:)]);
+    });
+
+    RDBenchmarkStruct const sample = { .a = 1, .b = 2, .x = 3, .y = 4 };
+    runner.run("invoke/objc_msgSend/stret", RDBenchmarkBatch, [&] {
+        for (NSUInteger i = 0; i < RDBenchmarkBatch; ++i)
+            RDBenchmarkDoNotOptimize([target swapFieldsIn:sample]);
+    });
+
+    RDInvocation *stretInvocation = [RDInvocation invocationWithArguments:RDValueTuple(sample)];
+    runner.run("invoke/RDInvocation/stret", RDBenchmarkBatch, [&] {
+        for (NSUInteger i = 0; i < RDBenchmarkBatch; ++i)
+            RDBenchmarkDoNotOptimize((__bridge void *)[stretInvocation invokeWithTarget:target selector:@selector(swapFieldsIn:)]);
+    });
+}
+
+static void RDBenchmarkBlocks(RDBenchmarkRunner &runner) {
+    NSUInteger (^nativeBlock)(NSUInteger) = ^NSUInteger(NSUInteger value) {
+        return value + 1;
+    };
+
+    runner.run("block/native", RDBenchmarkBatch, [&] {
+        for (NSUInteger i = 0; i < RDBenchmarkBatch; ++i)
+            RDBenchmarkDoNotOptimize(nativeBlock(i));
+    });
+
+    RDBenchmarkTarget *target = [RDBenchmarkTarget new];
+    NSUInteger (^objectBlock)(NSUInteger) = (id)target.asBlock;
+    runner.run("block/RDBlockObject", RDBenchmarkBatch, [&] {
+        for (NSUInteger i = 0; i < RDBenchmarkBatch; ++i)
+            RDBenchmarkDoNotOptimize(objectBlock(i));
+    });
+
+    runner.run("block/RDBlockObject/lifecycle", RDBenchmarkBatch, [&] {
+        for (NSUInteger i = 0; i < RDBenchmarkBatch; ++i)
+            RDBenchmarkDoNotOptimize((__bridge void *)[RDBenchmarkTarget new]);
+    });
+}
+
+static void RDBenchmarkCloning(RDBenchmarkRunner &runner) {
+    NSObject *owner = [NSObject new];
+    RDBenchmarkModel *model = [RDBenchmarkModel new];
+    model->_identifier = 42;
+    model->_title = @"model";
+    model->_created = [NSDate date];
+    model->_owner = owner;
+    model->_tags = @[ @"a", @"b" ];
+
+    runner.run("clone/copyWithZone", RDBenchmarkBatch, [&] {
+        for (NSUInteger i = 0; i < RDBenchmarkBatch; ++i)
+            RDBenchmarkDoNotOptimize((__bridge void *)[model copy]);
+    });
+
+    runner.run("clone/RDClone", RDBenchmarkBatch, [&] {
+        for (NSUInteger i = 0; i < RDBenchmarkBatch; ++i)
+            RDBenchmarkDoNotOptimize((__bridge void *)RDClone(model, NULL));
+    });
+}
+
+static void RDBenchmarkConversions(RDBenchmarkRunner &runner) {
+    typedef struct { float a, b; unsigned x, y; } RDBenchmarkNarrowStruct;
+    RDTypeConverter *converter = [RDTypeConverter converterFromType:[RDType typeWithObjcTypeEncoding:@encode(RDBenchmarkStruct)]
+                                                             toType:[RDType typeWithObjcTypeEncoding:@encode(RDBenchmarkNarrowStruct)]
+                                                            options:RDTypeConverterOptionsNone
+                                                              error:NULL];
+    std::vector<RDBenchmarkStruct> source(RDBenchmarkBatch, { .a = 1, .b = 2, .x = 3, .y = 4 });
+    std::vector<RDBenchmarkNarrowStruct> destination(RDBenchmarkBatch);
+
+    runner.run("convert/handWritten", RDBenchmarkBatch, [&] {
+        for (NSUInteger i = 0; i < RDBenchmarkBatch; ++i)
+            destination[i] = { (float)source[i].a, (float)source[i].b, (unsigned)source[i].x, (unsigned)source[i].y };
+        RDBenchmarkDoNotOptimize(destination.data());
+    });
+
+    runner.run("convert/RDTypeConverter", RDBenchmarkBatch, [&] {
+        [converter convertBytes:source.data() toBytes:destination.data() count:RDBenchmarkBatch];
+        RDBenchmarkDoNotOptimize(destination.data());
+    });
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void RDBenchmarkUsage(const char *program) {
+    fprintf(stderr,
+            "usage: %s [--samples N] [--warmup N] [--sample-time MS] [--mirror-samples N] [--filter SUBSTRING] [--output PATH]\n",
+            program);
+}
+
+int main(int argc, const char *argv[]) {
+    @autoreleasepool {
+        RDBenchmarkOptions options;
+        NSUInteger mirrorSamples = 5;
+        NSString *outputPath = nil;
+
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--help" || arg == "-h")
+                return RDBenchmarkUsage(argv[0]), 0;
+            if (i + 1 >= argc)
+                return RDBenchmarkUsage(argv[0]), 1;
+
+            const char *next = argv[++i];
+            if (arg == "--samples")
+                options.samples = MAX(strtoul(next, NULL, 10), 1ul);
+            else if (arg == "--warmup")
+                options.warmupSamples = strtoul(next, NULL, 10);
+            else if (arg == "--sample-time")
+                options.minimumSampleNanoseconds = strtod(next, NULL) * 1e6;
+            else if (arg == "--mirror-samples")
+                mirrorSamples = MAX(strtoul(next, NULL, 10), 1ul);
+            else if (arg == "--filter")
+                options.filter = next;
+            else if (arg == "--output")
+                outputPath = @(next);
+            else
+                return RDBenchmarkUsage(argv[0]), 1;
+        }
+
+        RDMetricsSetParseFailureSink(^(const char *__unused encoding, const char *__unused failurePosition) {});
+
+        RDBenchmarkCorpus corpus = RDBenchmarkHarvestCorpus();
+        RDBenchmarkRunner runner(options);
+        RDMetricsSnapshot *before = RDMetricsTakeSnapshot();
+
+        RDBenchmarkTypeParsing(runner, corpus);
+        RDBenchmarkMirroring(runner, mirrorSamples);
+        RDBenchmarkValues(runner);
+        RDBenchmarkInvocations(runner);
+        RDBenchmarkBlocks(runner);
+        RDBenchmarkCloning(runner);
+        RDBenchmarkConversions(runner);
+
+        RDMetricsSnapshot *metrics = [RDMetricsTakeSnapshot() snapshotBySubtractingSnapshot:before];
+        NSProcessInfo *processInfo = NSProcessInfo.processInfo;
+        NSDictionary *json = runner.jsonObject(@{
+            @"host": @{
+                @"operatingSystem": processInfo.operatingSystemVersionString,
+                @"processorCount": @(processInfo.activeProcessorCount),
+                @"physicalMemory": @(processInfo.physicalMemory),
+            },
+            @"corpus": @{
+                @"types": @(corpus.types.size()),
+                @"methodSignatures": @(corpus.methods.size()),
+                @"propertySignatures": @(corpus.properties.size()),
+            },
+            @"metrics": metrics.dictionaryRepresentation,
+        });
+
+        NSError *error = nil;
+        NSData *data = [NSJSONSerialization dataWithJSONObject:json
+                                                       options:NSJSONWritingPrettyPrinted | NSJSONWritingSortedKeys
+                                                         error:&error];
+        if (data == nil) {
+            fprintf(stderr, "Failed to serialize results: %s\n", error.localizedDescription.UTF8String);
+            return 1;
+        }
+
+        if (outputPath != nil) {
+            if (![data writeToFile:outputPath options:NSDataWritingAtomic error:&error]) {
+                fprintf(stderr, "Failed to write %s: %s\n", outputPath.UTF8String, error.localizedDescription.UTF8String);
+                return 1;
+            }
+        } else {
+            fwrite(data.bytes, 1, data.length, stdout);
+            fputc('\n', stdout);
+        }
+    }
+    return 0;
+}
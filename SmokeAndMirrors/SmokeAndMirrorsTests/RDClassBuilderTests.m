@@ -22,4 +22,28 @@
 //    XCTAssertNotNil(cls);
 }
 
+- (void)testMirrorRevalidation {
+    __unsafe_unretained Class cls = objc_allocateClassPair(NSObject.self, "RDClassBuilderRevalidationTest", 0);
+    objc_registerClassPair(cls);
+
+    RDSmoke *smoke = [RDSmoke new];
+    RDClass *mirror = [smoke mirrorForObjcClass:cls];
+    XCTAssertEqual(mirror.methods.count, 0u);
+    uint64_t generation = mirror.generation;
+
+    class_addMethod(cls, @selector(description), imp_implementationWithBlock(^{ return @""; }), "@@:");
+    XCTAssertEqual(mirror.methods.count, 0u, @"Changes made behind the library's back are invisible until invalidated");
+    NSArray *ivars = mirror.ivars;
+    RDInvalidateClass(cls, RDClassMembersMethods);
+    XCTAssertEqual(mirror.methods.count, 1u);
+    XCTAssertGreaterThan(mirror.generation, generation);
+    XCTAssertTrue(mirror.ivars == ivars, @"Only the invalidated members should be rebuilt");
+    XCTAssertTrue([smoke mirrorForObjcClass:cls] == mirror);
+
+    RDClassBuilder *builder = [RDClassBuilder new];
+    [builder addProtocolConformance:@protocol(NSCopying)];
+    [builder buildUpon:cls];
+    XCTAssertEqualObjects([mirror.protocols.firstObject name], @"NSCopying");
+}
+
 @end
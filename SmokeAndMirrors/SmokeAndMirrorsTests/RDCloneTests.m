@@ -0,0 +1,179 @@
+#import <XCTest/XCTest.h>
+
+#import "SmokeAndMirrors.h"
+
+@interface RDCloneChild : NSObject {
+@public
+    long _value;
+}
+@end
+
+@implementation RDCloneChild
+@end
+
+@interface RDCloneSample : NSObject<RDDeepCloning> {
+@public
+    double _ratio;
+    NSString *_name;
+    char _flag;
+    __weak id _delegate;
+    NSMutableString *_log;
+    RDCloneChild *_child;
+    RDCloneChild *_sharedChild;
+}
+@end
+
+@implementation RDCloneSample
+
++ (NSArray<NSString *> *)rd_deepClonedIvarNames {
+    return @[ @"_log", @"_child" ];
+}
+
+@end
+
+@interface RDCloneFailingCopy : NSObject<NSCopying>
+@end
+
+@implementation RDCloneFailingCopy
+
+- (id)copyWithZone:(NSZone *)zone {
+    return nil;
+}
+
+@end
+
+@interface RDCloneNode : NSObject<RDDeepCloning> {
+@public
+    RDCloneNode *_next;
+    RDCloneChild *_payload;
+    id _extra;
+}
+@end
+
+@implementation RDCloneNode
+
++ (NSArray<NSString *> *)rd_deepClonedIvarNames {
+    return @[ @"_next", @"_payload", @"_extra" ];
+}
+
+@end
+
+// Without strong or weak ivars ARC emits no layouts, but the slot is still not owned
+@interface RDCloneUnretainedSample : NSObject {
+@public
+    __unsafe_unretained id _target;
+}
+@end
+
+@implementation RDCloneUnretainedSample
+@end
+
+@interface RDCloneTests : XCTestCase
+@end
+
+@implementation RDCloneTests
+
+- (void)testClone {
+    RDCloneSample *sample = [RDCloneSample new];
+    sample->_ratio = 0.25;
+    sample->_name = [NSString stringWithFormat:@"sample %d", 1];
+    sample->_flag = 'y';
+    sample->_log = [NSMutableString stringWithString:@"log"];
+    sample->_child = [RDCloneChild new];
+    sample->_child->_value = 7;
+    sample->_sharedChild = [RDCloneChild new];
+
+    RDCloneSample *clone = nil;
+    @autoreleasepool {
+        NSObject *delegate = [NSObject new];
+        sample->_delegate = delegate;
+
+        NSError *error = nil;
+        clone = RDClone(sample, &error);
+        XCTAssertNil(error);
+        XCTAssertNotEqual(clone, sample);
+        XCTAssertEqual(clone.class, RDCloneSample.self);
+        XCTAssertEqual(clone->_ratio, 0.25);
+        XCTAssertEqual(clone->_flag, 'y');
+        XCTAssertEqual(clone->_name, sample->_name);
+        XCTAssertEqual(clone->_sharedChild, sample->_sharedChild);
+        XCTAssertEqual(clone->_delegate, delegate);
+
+        XCTAssertNotEqual(clone->_log, sample->_log);
+        XCTAssertEqualObjects(clone->_log, @"log");
+        [clone->_log appendString:@"!"];
+        XCTAssertEqualObjects(sample->_log, @"log", @"Mutable values stay mutable and separate in the clone");
+        XCTAssertNotEqual(clone->_child, sample->_child);
+        XCTAssertEqual(clone->_child->_value, 7);
+    }
+
+    XCTAssertNil(clone->_delegate, @"Weak slot of the clone is registered with the runtime");
+    sample = nil;
+    XCTAssertEqualObjects(clone->_name, @"sample 1", @"Strong slots are retained by the clone");
+}
+
+- (void)testCycles {
+    RDCloneNode *first = [RDCloneNode new];
+    RDCloneNode *second = [RDCloneNode new];
+    first->_next = second;
+    second->_next = first;
+    first->_payload = second->_payload = [RDCloneChild new];
+
+    NSError *error = nil;
+    RDCloneNode *clone = RDClone(first, &error);
+    XCTAssertNil(error);
+    XCTAssertNotEqual(clone, first);
+    XCTAssertNotEqual(clone->_next, second);
+    XCTAssertEqual(clone->_next->_next, clone);
+    XCTAssertNotEqual(clone->_payload, first->_payload);
+    XCTAssertEqual(clone->_next->_payload, clone->_payload, @"Values shared by the original are shared by the clone");
+
+    clone->_next->_next = nil;
+    second->_next = nil;
+}
+
+- (void)testUnownedSlots {
+    NSObject *target = [NSObject new];
+    RDCloneUnretainedSample *sample = [RDCloneUnretainedSample new];
+    sample->_target = target;
+
+    CFIndex retainCount = CFGetRetainCount((__bridge CFTypeRef)target);
+    RDCloneUnretainedSample *clone = RDClone(sample, NULL);
+    XCTAssertEqual(clone->_target, target);
+    XCTAssertEqual(CFGetRetainCount((__bridge CFTypeRef)target), retainCount, @"Unowned slots are copied without a retain");
+}
+
+- (void)testFailingCopy {
+    RDCloneNode *node = [RDCloneNode new];
+    node->_payload = [RDCloneChild new];
+    node->_extra = [RDCloneFailingCopy new];
+
+    NSError *error = nil;
+    XCTAssertNil(RDClone(node, &error));
+    XCTAssertEqualObjects(error.domain, RDCloneErrorDomain);
+    XCTAssertEqual(error.code, RDCloneCopyFailedErrorCode);
+}
+
+- (void)testObservedObjects {
+    RDCloneChild *child = [RDCloneChild new];
+    [child addObserver:self forKeyPath:@"value" options:0 context:NULL];
+    XCTAssertNotEqual(object_getClass(child), RDCloneChild.self);
+
+    RDCloneChild *clone = RDClone(child, NULL);
+    [child removeObserver:self forKeyPath:@"value"];
+    XCTAssertEqual(object_getClass(clone), RDCloneChild.self, @"The clone doesn't inherit the KVO subclass");
+}
+
+- (void)testUnsupportedObjects {
+    NSError *error = nil;
+    XCTAssertNil(RDClone(@[ @1, @2 ], &error), @"Array storage lives past its instance size");
+    XCTAssertEqualObjects(error.domain, RDCloneErrorDomain);
+    XCTAssertEqual(error.code, RDCloneUnsupportedClassErrorCode);
+
+    int captured = 1;
+    XCTAssertNil(RDClone([^{ (void)captured; } copy], NULL));
+    XCTAssertNil(RDClone(NSObject.self, NULL));
+    XCTAssertNil(RDClone(nil, NULL));
+}
+
+@end
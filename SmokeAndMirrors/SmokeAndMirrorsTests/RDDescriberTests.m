@@ -0,0 +1,75 @@
+#import <XCTest/XCTest.h>
+
+#import "SmokeAndMirrors.h"
+
+@interface RDDescriberNode : NSObject {
+@public
+    int _tag;
+    RDDescriberNode *_next;
+    __weak RDDescriberNode *_owner;
+}
+@end
+
+@implementation RDDescriberNode
+@end
+
+@interface RDDescriberTests : XCTestCase
+@end
+
+@implementation RDDescriberTests
+
+- (void)testElementLimit {
+    struct { int values[6]; } sample = { .values = { 1, 2, 3, 4, 5, 6 } };
+    RDDescriber *describer = [RDDescriber new];
+    describer.maxElements = 2;
+    [describer describeBytes:&sample ofType:[RDType typeWithObjcTypeEncoding:@encode(typeof(sample))]];
+    XCTAssertTrue([describer.string containsString:@"{ 1, 2, ... 4 more }"], @"%@", describer.string);
+}
+
+- (void)testDepthLimit {
+    struct { struct { struct { int value; } inner; } middle; } sample = {};
+    RDDescriber *describer = [RDDescriber new];
+    describer.maxDepth = 2;
+    [describer describeBytes:&sample ofType:[RDType typeWithObjcTypeEncoding:@encode(typeof(sample))]];
+    XCTAssertTrue([describer.string containsString:@"{ ... }"], @"%@", describer.string);
+}
+
+- (void)testCompactCycle {
+    RDDescriberNode *first = [RDDescriberNode new];
+    RDDescriberNode *second = [RDDescriberNode new];
+    first->_tag = 1;
+    first->_next = second;
+    second->_tag = 2;
+    second->_next = first;
+    second->_owner = first;
+
+    RDDescriber *describer = [RDDescriber new];
+    describer.options = RDDescriberOptionsCompact | RDDescriberOptionsFollowObjects;
+    [describer describeObject:first];
+
+    NSString *string = describer.string;
+    XCTAssertFalse([string containsString:@"\n"], @"%@", string);
+    XCTAssertTrue([string containsString:@"_tag = 2"], @"%@", string);
+    XCTAssertTrue([string containsString:@"<visited>"], @"%@", string);
+
+    [describer reset];
+    XCTAssertEqual(describer.length, 0u);
+    second->_next = nil;
+}
+
+- (void)testFileDescriptor {
+    int fds[2];
+    XCTAssertEqual(pipe(fds), 0);
+
+    RDDescriber *describer = [[RDDescriber alloc] initWithFileDescriptor:fds[1]];
+    [describer describeObject:[RDDescriberNode new]];
+    XCTAssertEqual(describer.length, 0u, @"Should flush after each describe call");
+    close(fds[1]);
+
+    char buffer[256] = {};
+    XCTAssertGreaterThan(read(fds[0], buffer, sizeof(buffer) - 1), 0);
+    XCTAssertTrue(strstr(buffer, "RDDescriberNode") != NULL, @"%s", buffer);
+    close(fds[0]);
+}
+
+@end
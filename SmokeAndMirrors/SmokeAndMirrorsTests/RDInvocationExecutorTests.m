@@ -0,0 +1,76 @@
+#import <XCTest/XCTest.h>
+
+#import "SmokeAndMirrors.h"
+
+#include <stdatomic.h>
+
+typedef struct {
+    long value;
+    id object;
+} RDInvocationExecutorArguments;
+
+@interface RDInvocationExecutorTarget : NSObject
+@end
+
+@implementation RDInvocationExecutorTarget {
+    atomic_long _total;
+}
+
+- (long)addValue:(long)value object:(id)object {
+    return atomic_fetch_add(&_total, object == nil ? 0 : value) + value;
+}
+
+- (double)scaleValue:(double)value object:(id)object {
+    return value;
+}
+
+- (long)total {
+    return atomic_load(&_total);
+}
+
+@end
+
+@interface RDInvocationExecutorTests : XCTestCase
+@end
+
+@implementation RDInvocationExecutorTests
+
+- (void)testConcurrentSubmission {
+    RDAggregateType *type = RD_CAST([RDType typeWithObjcTypeEncoding:@encode(RDInvocationExecutorArguments)], RDAggregateType);
+    __block atomic_long completed = 0;
+    __block atomic_long failed = 0;
+    RDInvocationExecutor *executor = [[RDInvocationExecutor alloc] initWithArgumentsType:type
+                                                                                capacity:64
+                                                                             workerCount:3
+                                                                              completion:^(id target, SEL selector, void *context, const void *result, RDType *resultType, NSError *error) {
+        if (error != nil)
+            atomic_fetch_add(&failed, 1);
+        else
+            atomic_fetch_add(&completed, 1);
+    }];
+    XCTAssertNotNil(executor);
+    XCTAssertEqual(executor.capacity, 64u);
+
+    RDInvocationExecutorTarget *target = [RDInvocationExecutorTarget new];
+    dispatch_apply(8, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t producer) {
+        for (long i = 0; i < 1000; ++i) {
+            RDInvocationExecutorArguments arguments = { .value = 1, .object = [NSObject new] };
+            [executor submitWithTarget:target selector:@selector(addValue:object:) arguments:&arguments context:(void *)producer];
+        }
+    });
+    [executor submitWithTarget:target selector:@selector(total) arguments:NULL context:NULL];
+    RDInvocationExecutorArguments mismatched = { .value = 1, .object = nil };
+    [executor submitWithTarget:target selector:@selector(scaleValue:object:) arguments:&mismatched context:NULL];
+    [executor waitUntilIdle];
+
+    XCTAssertEqual(target.total, 8000);
+    XCTAssertEqual(atomic_load(&completed), 8000);
+    XCTAssertEqual(atomic_load(&failed), 2, @"Argument count and type mismatches should be reported through the completion");
+}
+
+- (void)testRejectsNonStructArguments {
+    RDAggregateType *type = RD_CAST([RDType typeWithObjcTypeEncoding:"(?=iq)"], RDAggregateType);
+    XCTAssertNil([[RDInvocationExecutor alloc] initWithArgumentsType:type capacity:4 workerCount:1 completion:nil]);
+}
+
+@end
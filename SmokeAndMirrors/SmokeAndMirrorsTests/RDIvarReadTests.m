@@ -0,0 +1,101 @@
+#import <XCTest/XCTest.h>
+#import <objc/runtime.h>
+
+#import "SmokeAndMirrors.h"
+
+typedef struct {
+    long first;
+    long second;
+    long third;
+} RDIvarReadTriple;
+
+@interface RDIvarReadSample : NSObject<RDSequencedIvars> {
+@public
+    RDSequence _sequence;
+    RDIvarReadTriple _triple;
+    long _counter;
+    __weak id _delegate;
+}
+@end
+
+@implementation RDIvarReadSample
+
++ (ptrdiff_t)rd_ivarSequenceOffset {
+    return ivar_getOffset(class_getInstanceVariable(self, "_sequence"));
+}
+
+@end
+
+@interface RDIvarReadTests : XCTestCase
+@end
+
+@implementation RDIvarReadTests
+
+- (RDIvar *)ivarNamed:(NSString *)name {
+    for (RDIvar *ivar in [[RDSmoke currentThreadSmoke] mirrorForObjcClass:RDIvarReadSample.self].ivars)
+        if ([ivar.name isEqualToString:name])
+            return ivar;
+    return nil;
+}
+
+- (void)testAccessKinds {
+    RDIvarReadSample *sample = [RDIvarReadSample new];
+    sample->_counter = 42;
+    sample->_delegate = self;
+
+    long counter = 0;
+    XCTAssertEqual([[self ivarNamed:@"_counter"] readFromObject:sample into:&counter], RDIvarReadConsistencyAtomic);
+    XCTAssertEqual(counter, 42);
+
+    __unsafe_unretained id delegate = nil;
+    XCTAssertEqual([[self ivarNamed:@"_delegate"] readFromObject:sample into:&delegate], RDIvarReadConsistencyWeak);
+    XCTAssertEqual(delegate, self);
+}
+
+- (void)testIvarsMirroredBeforeTheirClass {
+    RDIvarReadSample *sample = [RDIvarReadSample new];
+    sample->_delegate = self;
+    RDSmoke *smoke = [RDSmoke new];
+    RDIvar *ivar = [smoke mirrorForObjcIvar:class_getInstanceVariable(RDIvarReadSample.self, "_delegate")];
+
+    __unsafe_unretained id delegate = nil;
+    XCTAssertEqual([ivar readFromObject:sample into:&delegate], RDIvarReadConsistencyAtomic,
+                   @"Without its class the ivar can't know it is weak");
+    XCTAssertNotNil([smoke mirrorForObjcClass:RDIvarReadSample.self]);
+    XCTAssertEqual([ivar readFromObject:sample into:&delegate], RDIvarReadConsistencyWeak,
+                   @"Mirroring the class replaces the read plan");
+    XCTAssertEqual(delegate, self);
+}
+
+- (void)testSequencedReadsDoNotTear {
+    RDIvarReadSample *sample = [RDIvarReadSample new];
+    RDIvar *ivar = [self ivarNamed:@"_triple"];
+    RDIvarReadTriple triple;
+    XCTAssertEqual([ivar readFromObject:sample into:&triple], RDIvarReadConsistencySequenced);
+    __block volatile BOOL done = NO;
+
+    dispatch_group_t group = dispatch_group_create();
+    dispatch_group_async(group, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        for (long i = 1; !done; ++i) {
+            RDSequenceBeginWrite(&sample->_sequence);
+            sample->_triple = (RDIvarReadTriple) { i, i, i };
+            RDSequenceEndWrite(&sample->_sequence);
+        }
+    });
+
+    NSUInteger sequenced = 0;
+    for (NSUInteger i = 0; i < 100000; ++i) {
+        RDIvarReadConsistency consistency = [ivar readFromObject:sample into:&triple];
+        XCTAssertTrue(consistency == RDIvarReadConsistencySequenced || consistency == RDIvarReadConsistencyNone,
+                      @"Only a writer outlasting every retry should make the read fall back to a plain copy");
+        if (consistency == RDIvarReadConsistencySequenced) {
+            XCTAssertTrue(triple.first == triple.second && triple.second == triple.third);
+            ++sequenced;
+        }
+    }
+    done = YES;
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    XCTAssertGreaterThan(sequenced, 0u);
+}
+
+@end
@@ -0,0 +1,91 @@
+#import <XCTest/XCTest.h>
+
+#import "SmokeAndMirrors.h"
+
+@interface RDObjectGraphNodeSample : NSObject {
+@public
+    id _child;
+    __weak id _parent;
+    __unsafe_unretained id _peer;
+}
+@end
+
+@implementation RDObjectGraphNodeSample
+@end
+
+@interface RDObjectGraphLeafSample : NSObject {
+@public
+    long _payload[8];
+}
+@end
+
+@implementation RDObjectGraphLeafSample
+@end
+
+// ARC leaves a class without strong or weak ivars with no layouts, just like code built without ARC
+@interface RDObjectGraphUnretainedSample : NSObject {
+@public
+    __unsafe_unretained id _target;
+}
+@end
+
+@implementation RDObjectGraphUnretainedSample
+@end
+
+@interface RDObjectGraphAnalyzerTests : XCTestCase
+@end
+
+@implementation RDObjectGraphAnalyzerTests
+
+- (RDObjectGraphClassStatistics *)statisticsForClass:(Class)cls inReport:(RDObjectGraphReport *)report {
+    for (RDObjectGraphClassStatistics *statistics in report.classStatistics)
+        if (statistics.objcClass == cls)
+            return statistics;
+    return nil;
+}
+
+- (void)testRetainedSizes {
+    // Two chains share a leaf, so it is retained by neither of them alone
+    RDObjectGraphLeafSample *shared = [RDObjectGraphLeafSample new];
+    NSMutableArray *roots = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 2; ++i) {
+        RDObjectGraphNodeSample *head = [RDObjectGraphNodeSample new];
+        RDObjectGraphNodeSample *tail = [RDObjectGraphNodeSample new];
+        head->_child = tail;
+        tail->_parent = head;
+        tail->_peer = shared;
+        tail->_child = @[ shared, [RDObjectGraphLeafSample new] ];
+        [roots addObject:head];
+    }
+
+    RDObjectGraphReport *report = [[[RDObjectGraphAnalyzer alloc] initWithConcurrency:2] analyzeRoots:roots];
+    XCTAssertEqual(report.objectCount, 2u * 4 + 1, @"Weak and unretained ivars are not followed");
+
+    RDObjectGraphClassStatistics *nodes = [self statisticsForClass:RDObjectGraphNodeSample.self inReport:report];
+    XCTAssertEqual(nodes.instanceCount, 4u);
+    RDObjectGraphClassStatistics *leaves = [self statisticsForClass:RDObjectGraphLeafSample.self inReport:report];
+    XCTAssertEqual(leaves.instanceCount, 3u);
+
+    size_t root = [report retainedSizeOfRootAtIndex:0];
+    XCTAssertGreaterThan(root, 0u);
+    XCTAssertEqual(root, [report retainedSizeOfRootAtIndex:1]);
+    XCTAssertEqual(root * 2 + leaves.shallowSize / 3, report.totalSize);
+    XCTAssertEqual(nodes.retainedSize, root * 2, @"Tails are dominated by heads and are not counted twice");
+
+    RDObjectGraphAnalyzer *shallow = [RDObjectGraphAnalyzer new];
+    shallow.followsCollections = NO;
+    XCTAssertEqual([shallow analyzeRoots:roots].objectCount, 2u * 3);
+}
+
+- (void)testUnretainedOnlyClasses {
+    RDObjectGraphUnretainedSample *sample = [RDObjectGraphUnretainedSample new];
+    RDObjectGraphLeafSample *leaf = [RDObjectGraphLeafSample new];
+    sample->_target = leaf;
+
+    RDIvar *ivar = [[RDSmoke currentThreadSmoke] mirrorForObjcClass:RDObjectGraphUnretainedSample.self].ivars.firstObject;
+    XCTAssertEqual(ivar.retention, RDRetentionTypeUnsafeUnretained);
+    XCTAssertFalse(ivar.owning);
+    XCTAssertEqual([[RDObjectGraphAnalyzer new] analyzeRoots:@[ sample ]].objectCount, 1u);
+}
+
+@end
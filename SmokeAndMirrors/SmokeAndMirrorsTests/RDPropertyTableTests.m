@@ -0,0 +1,130 @@
+#import <XCTest/XCTest.h>
+
+#import "SmokeAndMirrors.h"
+
+@interface RDPropertyTableTestBase : NSObject
+@property (nonatomic, copy) NSString *title;
+@property (readonly) NSInteger count;
+@end
+
+@implementation RDPropertyTableTestBase
+@end
+
+@interface RDPropertyTableTestDerived : RDPropertyTableTestBase
+@property (nonatomic, getter=isEnabled, setter=markEnabled:) BOOL enabled;
+@property (weak) id delegate;
+@end
+
+@implementation RDPropertyTableTestDerived
+@end
+
+@interface RDPropertyTableTestOverride : RDPropertyTableTestBase
+@end
+
+@implementation RDPropertyTableTestOverride
+
+- (NSString *)title {
+    return [super.title stringByAppendingString:@"?"];
+}
+
+@end
+
+@interface RDPropertyTableTests : XCTestCase
+@end
+
+@implementation RDPropertyTableTests
+
+- (void)testSignatureAttributes {
+    RDPropertySignature *signature = [RDPropertySignature signatureWithObjcTypeEncoding:"Tc,N,GisEnabled,SmarkEnabled:,V_enabled"];
+    XCTAssertEqual(signature.flags, RDPropertyAttributeFlagNonatomic | RDPropertyAttributeFlagGetter
+                                  | RDPropertyAttributeFlagSetter | RDPropertyAttributeFlagIvarName);
+    XCTAssertEqual(signature.attributesCount, 4u);
+    XCTAssertEqual(signature.getter, @selector(isEnabled));
+    XCTAssertEqual(signature.setter, @selector(markEnabled:));
+    XCTAssertEqualObjects(signature.ivarName, @"_enabled");
+    XCTAssertEqualObjects([signature attributeWithKind:RDPropertyAttributeKindGetter]->value, @"isEnabled");
+    XCTAssertTrue([signature attributeWithKind:RDPropertyAttributeKindCopy] == NULL);
+    XCTAssertEqual(strcmp(signature.objcTypeEncoding, "Tc,N,GisEnabled,SmarkEnabled:,V_enabled"), 0);
+}
+
+- (void)testTable {
+    RDPropertyTable *table = [RDPropertyTable tableForClass:RDPropertyTableTestDerived.self];
+    XCTAssertEqual(table.count, 4u);
+    XCTAssertTrue([RDPropertyTable tableForClass:RDPropertyTableTestDerived.self] == table);
+
+    const RDPropertyEntry *enabled = [table entryWithName:@"enabled"];
+    XCTAssertEqual(enabled->getter, @selector(isEnabled));
+    XCTAssertEqual(enabled->setter, @selector(markEnabled:));
+    XCTAssertTrue(enabled->getterMethod != NULL);
+    XCTAssertEqual(enabled->ivarOffset, (RDOffset)ivar_getOffset(class_getInstanceVariable(RDPropertyTableTestDerived.self, "_enabled")));
+
+    const RDPropertyEntry *count = [table entryWithName:@"count"];
+    XCTAssertTrue(count->flags & RDPropertyAttributeFlagReadOnly);
+    XCTAssertTrue(count->setter == NULL);
+    XCTAssertTrue([table entryWithName:@"missing"] == NULL);
+
+    const RDPropertyEntry *delegate = [table entryWithName:@"delegate"];
+    XCTAssertTrue(delegate->flags & RDPropertyAttributeFlagWeak);
+    XCTAssertEqual(delegate->setter, @selector(setDelegate:));
+}
+
+- (void)testAccessors {
+    RDPropertyTable *table = [RDPropertyTable tableForClass:RDPropertyTableTestDerived.self];
+    RDPropertyTableTestDerived *object = [RDPropertyTableTestDerived new];
+
+    const RDPropertyEntry *title = [table entryWithName:@"title"];
+    NSMutableString *value = [NSMutableString stringWithString:@"title"];
+    XCTAssertTrue(RDPropertySetObject(title, object, value));
+    [value appendString:@"!"];
+    XCTAssertEqualObjects(RDPropertyGetObject(title, object), @"title", @"Setter semantics are preserved");
+    XCTAssertFalse(RDPropertySetObject([table entryWithName:@"enabled"], object, @YES));
+
+    RDPropertyTableTestOverride *override = [RDPropertyTableTestOverride new];
+    const RDPropertyEntry *baseTitle = [[RDPropertyTable tableForClass:RDPropertyTableTestBase.self] entryWithName:@"title"];
+    XCTAssertTrue(RDPropertySetObject(baseTitle, override, @"title"));
+    XCTAssertEqualObjects(RDPropertyGetObject(baseTitle, override), @"title?", @"Subclass overrides are called");
+}
+
+- (void)testBuiltProperty {
+    RDClassBuilder *builder = [RDClassBuilder new];
+    [builder addPropertyWithName:@"value" signature:[RDPropertySignature signatureWithObjcTypeEncoding:"T@\"NSString\",C,N,V_value"]];
+    Class cls = [builder buildNamed:@"RDPropertyTableBuiltTest"];
+    XCTAssertNotNil(cls);
+    XCTAssertEqualObjects(@(property_getAttributes(class_getProperty(cls, "value"))), @"T@\"NSString\",C,N,V_value");
+}
+
+- (void)testDisposedClass {
+    RDClassBuilder *builder = [RDClassBuilder new];
+    [builder addPropertyWithName:@"value" signature:[RDPropertySignature signatureWithObjcTypeEncoding:"T@\"NSString\",C,N,V_value"]];
+    Class cls = [builder buildNamed:@"RDPropertyTableDisposedTest"];
+    RDSmoke *smoke = [RDSmoke new];
+    RDClass *mirror = [smoke mirrorForObjcClass:cls];
+    __weak RDPropertyTable *weakTable = nil;
+    uint64_t generation = 0;
+    @autoreleasepool {
+        RDPropertyTable *table = [RDPropertyTable tableForClass:cls];
+        XCTAssertNotNil([table entryWithName:@"value"]);
+        weakTable = table;
+        generation = table.generation;
+    }
+
+    RDDisposeClass(cls);
+    XCTAssertGreaterThan(RDRuntimeGeneration(), generation);
+    @autoreleasepool {
+        [RDPropertyTable tableForClass:RDPropertyTableTestDerived.self];
+    }
+    XCTAssertNil(weakTable, @"Tables of disposed classes are dropped on the next rebuild");
+
+    // Only telling when the allocator hands the freed address out again, which it usually does right away
+    Class reused = [[RDClassBuilder new] buildNamed:@"RDPropertyTableReusedTest"];
+    XCTAssertNotNil(reused);
+    if (reused == cls) {
+        RDClass *reusedMirror = [smoke mirrorForObjcClass:reused];
+        XCTAssertTrue(reusedMirror != mirror);
+        XCTAssertEqualObjects(reusedMirror.name, @"RDPropertyTableReusedTest");
+        XCTAssertEqual(reusedMirror.properties.count, 0u);
+        XCTAssertTrue([[RDPropertyTable tableForClass:reused] entryWithName:@"value"] == NULL);
+    }
+}
+
+@end
@@ -0,0 +1,101 @@
+#import <XCTest/XCTest.h>
+
+#import "SmokeAndMirrors.h"
+
+@protocol RDRuntimeIndexBaseProtocol <NSObject>
+@end
+
+@protocol RDRuntimeIndexProtocol <RDRuntimeIndexBaseProtocol>
+@end
+
+typedef struct {
+    int x, y;
+} RDRuntimeIndexPoint;
+
+@interface RDRuntimeIndexDummy : NSObject<RDRuntimeIndexProtocol> {
+    RDRuntimeIndexPoint _point;
+}
+@end
+
+@implementation RDRuntimeIndexDummy
+
++ (void)rd_runtimeIndexClassMethod {
+}
+
+- (void)rd_runtimeIndexInstanceMethod {
+}
+
+@end
+
+@interface RDRuntimeIndexDummySubclass : RDRuntimeIndexDummy
+@end
+
+@implementation RDRuntimeIndexDummySubclass
+@end
+
+@interface RDRuntimeIndexTests : XCTestCase
+@end
+
+@implementation RDRuntimeIndexTests
+
+- (void)testQueries {
+    RDRuntimeIndex *index = [[RDRuntimeIndex alloc] initWithConcurrency:0];
+    XCTAssertGreaterThan([index refresh], 0u);
+    XCTAssertEqual([index refresh], 0u, @"Second refresh should have nothing new to index");
+
+    XCTAssertEqualObjects([index classesImplementingInstanceSelector:@selector(rd_runtimeIndexInstanceMethod)],
+                          @[RDRuntimeIndexDummy.self]);
+    XCTAssertEqualObjects([index classesImplementingClassSelector:@selector(rd_runtimeIndexClassMethod)],
+                          @[RDRuntimeIndexDummy.self]);
+
+    NSSet *conformers = [NSSet setWithArray:[index classesConformingToProtocol:@protocol(RDRuntimeIndexBaseProtocol)]];
+    XCTAssertEqualObjects(conformers, ([NSSet setWithObjects:RDRuntimeIndexDummy.self, RDRuntimeIndexDummySubclass.self, nil]));
+
+    RDType *type = [RDType typeWithObjcTypeEncoding:@encode(RDRuntimeIndexPoint)];
+    XCTAssertEqualObjects([index classesWithIvarOfType:type], @[RDRuntimeIndexDummy.self]);
+
+    __block NSUInteger matches = 0;
+    [index enumerateIvarsOfType:[RDType typeWithObjcTypeEncoding:"{?=\"x\"i\"y\"i}"] usingBlock:^(Class cls, RDIvar *ivar, BOOL *stop) {
+        XCTAssertEqualObjects(cls, RDRuntimeIndexDummy.self);
+        XCTAssertEqualObjects(ivar.name, @"_point");
+        ++matches;
+    }];
+    XCTAssertEqual(matches, 1u);
+}
+
+- (void)testIncrementalRefresh {
+    RDRuntimeIndex *index = [[RDRuntimeIndex alloc] initWithConcurrency:2];
+    [index refresh];
+    NSUInteger count = index.classCount;
+
+    Class cls = objc_allocateClassPair(NSObject.self, "RDRuntimeIndexDynamicClass", 0);
+    class_addMethod(cls, @selector(rd_runtimeIndexDynamicMethod), imp_implementationWithBlock(^{}), "v@:");
+    objc_registerClassPair(cls);
+
+    XCTAssertEqual([index refresh], 1u);
+    XCTAssertEqual(index.classCount, count + 1);
+    XCTAssertEqualObjects([index classesImplementingInstanceSelector:@selector(rd_runtimeIndexDynamicMethod)], @[cls]);
+}
+
+- (void)testDisposedClasses {
+    RDRuntimeIndex *index = [[RDRuntimeIndex alloc] initWithConcurrency:2];
+    [index refresh];
+    NSUInteger count = index.classCount;
+
+    Class cls = objc_allocateClassPair(NSObject.self, "RDRuntimeIndexDisposedClass", 0);
+    class_addMethod(cls, @selector(rd_runtimeIndexDisposedMethod), imp_implementationWithBlock(^{}), "v@:");
+    objc_registerClassPair(cls);
+    XCTAssertEqual([index refresh], 1u);
+
+    RDDisposeClass(cls);
+    XCTAssertEqualObjects([index classesImplementingInstanceSelector:@selector(rd_runtimeIndexDisposedMethod)], @[]);
+    XCTAssertEqual(index.classCount, count);
+
+    Class successor = objc_allocateClassPair(NSObject.self, "RDRuntimeIndexDisposedClass", 0);
+    objc_registerClassPair(successor);
+    XCTAssertEqual([index refresh], 1u, @"A class registered after a disposal is indexed even at a reused address");
+    XCTAssertEqual(index.classCount, count + 1);
+    RDDisposeClass(successor);
+}
+
+@end
@@ -0,0 +1,49 @@
+#import <XCTest/XCTest.h>
+
+#import "SmokeAndMirrors.h"
+
+@interface RDTemplatesTarget : NSObject
+@end
+
+@implementation RDTemplatesTarget
+
+- (double)scale:(double)value by:(int)factor {
+    return value * factor;
+}
+
+- (NSString *)greet:(NSString *)name {
+    return [@"Hello, " stringByAppendingString:name];
+}
+
+@end
+
+@interface RDTemplatesTests : XCTestCase
+@end
+
+@implementation RDTemplatesTests
+
+- (void)testInvoke {
+    RDTemplatesTarget *target = [RDTemplatesTarget new];
+    XCTAssertEqual((rd::invoke<double(double, int)>(target, @selector(scale:by:), 1.5, 4)), 6.0);
+    XCTAssertEqualObjects(rd::invoke<NSString *(NSString *)>(target, @selector(greet:), @"rd"), @"Hello, rd");
+    XCTAssertEqual((rd::invoke<double(double, int)>(nil, @selector(scale:by:), 1.5, 4)), 0.0);
+    XCTAssertThrows((rd::invoke<double(float, int)>(target, @selector(scale:by:), 1.5f, 4)));
+    XCTAssertThrows(rd::invoke<void()>(target, @selector(scale:by:)));
+}
+
+- (void)testFieldAccess {
+    struct { int count; double ratio; } sample = { 3, 0.5 };
+    RDValue *value = [RDValue valueWithBytes:&sample objCType:@encode(typeof(sample))];
+    XCTAssertEqual(rd::get<typeof(sample)>(value)->ratio, 0.5);
+    XCTAssertFalse(rd::get<int>(value).has_value());
+
+    RDType *named = [RDType typeWithObjcTypeEncoding:"{Named=\"count\"i\"ratio\"d}"];
+    RDMutableValue *namedValue = [RDMutableValue valueWithBytes:NULL ofType:named];
+    XCTAssertTrue(rd::set<int>(namedValue, "count", 7));
+    XCTAssertEqual(rd::get<int>(namedValue, "count").value_or(0), 7);
+    XCTAssertEqual(rd::get<int>(namedValue, "count").value_or(0), 7, @"Second lookup is served from the cache");
+    XCTAssertFalse(rd::get<float>(namedValue, "ratio").has_value());
+    XCTAssertFalse(rd::get<int>(namedValue, "missing").has_value());
+}
+
+@end
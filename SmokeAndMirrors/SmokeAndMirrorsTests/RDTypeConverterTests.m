@@ -0,0 +1,95 @@
+#import <XCTest/XCTest.h>
+
+#import "SmokeAndMirrors.h"
+
+typedef struct { int x, y; } RDConverterIntPoint;
+typedef struct { double x, y; } RDConverterDoublePoint;
+
+@interface RDTypeConverterTests : XCTestCase
+@end
+
+@implementation RDTypeConverterTests
+
+- (RDTypeConverter *)converterFrom:(const char *)source to:(const char *)destination options:(RDTypeConverterOptions)options {
+    return [RDTypeConverter converterFromType:[RDType typeWithObjcTypeEncoding:source]
+                                       toType:[RDType typeWithObjcTypeEncoding:destination]
+                                      options:options
+                                        error:NULL];
+}
+
+- (NSArray<NSString *> *)describeIssues:(RDTypeConverter *)converter {
+    NSMutableArray<NSString *> *result = [NSMutableArray array];
+    for (RDTypeConversionIssue *issue in converter.issues)
+        [result addObject:issue.description];
+    return result;
+}
+
+- (void)testWidening {
+    RDTypeConverter *converter = [self converterFrom:@encode(RDConverterIntPoint) to:@encode(RDConverterDoublePoint) options:RDTypeConverterOptionsNone];
+    XCTAssertEqual(converter.issues.count, 0u);
+
+    RDConverterIntPoint source[1000];
+    for (int i = 0; i < 1000; ++i)
+        source[i] = (RDConverterIntPoint){ i, -i };
+
+    RDConverterDoublePoint destination[1000];
+    [converter convertBytes:source toBytes:destination count:1000];
+    XCTAssertEqual(destination[0].x, 0.0);
+    XCTAssertEqual(destination[999].x, 999.0);
+    XCTAssertEqual(destination[999].y, -999.0);
+}
+
+- (void)testFieldsByName {
+    RDTypeConverter *converter = [self converterFrom:"{A=\"x\"i\"y\"d\"z\"c}"
+                                                  to:"{B=\"y\"i\"x\"q\"w\"f}"
+                                             options:RDTypeConverterMatchFieldsByName];
+    XCTAssertEqualObjects([self describeIssues:converter], (@[ @"lossy: y", @"unmapped destination: w", @"unmapped source: z" ]));
+
+    struct { int x; double y; char z; } source = { 7, 1e100, 'z' };
+    struct { int y; long long x; float w; } destination = { 1, 2, 3 };
+    [converter convertBytes:&source toBytes:&destination count:1];
+    XCTAssertEqual(destination.x, 7);
+    XCTAssertEqual(destination.y, INT_MAX, @"Floating point to integer conversions saturate");
+    XCTAssertEqual(destination.w, 0.0f);
+}
+
+- (void)testNestedArrays {
+    RDTypeConverter *converter = [self converterFrom:"[2[3i]]" to:"[2[3d]]" options:RDTypeConverterOptionsNone];
+    XCTAssertEqual(converter.issues.count, 0u);
+
+    int source[2][3] = { { 1, 2, 3 }, { 4, 5, 6 } };
+    double destination[2][3] = {};
+    [converter convertBytes:source toBytes:destination count:1];
+    for (int i = 0; i < 2; ++i)
+        for (int j = 0; j < 3; ++j)
+            XCTAssertEqual(destination[i][j], (double)source[i][j]);
+}
+
+- (void)testArraysAndObjects {
+    RDTypeConverter *converter = [self converterFrom:"{S=[4i]@}" to:"{D=[2f]@}" options:RDTypeConverterOptionsNone];
+    XCTAssertEqualObjects([self describeIssues:converter], (@[ @"lossy: 0[]", @"unmapped source: 0[2...3]" ]));
+
+    RDValue *value = [RDValue valueWithBytes:&(struct { int values[4]; __unsafe_unretained id object; }){ { 1, 2, 3, 4 }, self }
+                                      ofType:converter.sourceType];
+    RDValue *converted = [converter convertValue:value];
+    struct { float values[2]; __unsafe_unretained id object; } result;
+    memcpy(&result, [converted bufferType:NULL], sizeof(result));
+    XCTAssertEqual(result.values[1], 2.0f);
+    XCTAssertEqual(result.object, self);
+    XCTAssertNil([converter convertValue:RDValueBox(1)]);
+}
+
+- (void)testBitfieldsAreLeftAlone {
+    typedef struct { int a; unsigned flags : 8; int c; } RDConverterFlags;
+    RDTypeConverter *converter = [self converterFrom:@encode(RDConverterFlags) to:@encode(RDConverterFlags) options:RDTypeConverterOptionsNone];
+    XCTAssertEqualObjects([self describeIssues:converter], (@[ @"unmapped destination: 1" ]));
+
+    RDConverterFlags source = { 1, 0x11, 3 };
+    RDConverterFlags destination = { 0, 0x22, 0 };
+    [converter convertBytes:&source toBytes:&destination count:1];
+    XCTAssertEqual(destination.a, 1);
+    XCTAssertEqual(destination.flags, 0x22u, @"Copies of the fields around a bitfield are not merged over it");
+    XCTAssertEqual(destination.c, 3);
+}
+
+@end
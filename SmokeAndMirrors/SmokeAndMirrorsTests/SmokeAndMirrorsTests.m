@@ -35,4 +35,91 @@
     free(protocolList);
 }
 
+- (void)testMetrics {
+    __block NSUInteger failures = 0;
+    RDMetricsSetParseFailureSink(^(const char *__unused encoding, const char *__unused failurePosition) {
+        ++failures;
+    });
+    RDMetricsSetTimingEnabled(YES);
+
+    RDMetricsSnapshot *before = RDMetricsTakeSnapshot();
+    XCTAssertNotNil([RDType typeWithObjcTypeEncoding:"{CGPoint=dd}"]);
+    XCTAssertNil([RDType typeWithObjcTypeEncoding:"~"]);
+    XCTAssertNil([RDMethodSignature signatureWithObjcTypeEncoding:"~"]);
+    RDSmoke *smoke = [RDSmoke new];
+    RDClass *mirror = [smoke mirrorForObjcClass:NSObject.self];
+    XCTAssertEqual(mirror, [smoke mirrorForObjcClass:NSObject.self]);
+    RDMetricsSnapshot *delta = [RDMetricsTakeSnapshot() snapshotBySubtractingSnapshot:before];
+
+    RDMetricsSetTimingEnabled(NO);
+    RDMetricsSetParseFailureSink(nil);
+
+    XCTAssertGreaterThanOrEqual([delta valueForCounter:RDMetricsCounterTypeParseSucceeded], 1u);
+    XCTAssertEqual([delta valueForCounter:RDMetricsCounterTypeParseFailed], 2u);
+    XCTAssertEqual(failures, 1u, @"Failed type encodings are counted but not reported");
+    XCTAssertGreaterThanOrEqual([delta valueForCounter:RDMetricsCounterSmokeCacheHit], 1u);
+    XCTAssertGreaterThanOrEqual([delta valueForCounter:RDMetricsCounterClassMirrorConstruction], 1u);
+    XCTAssertGreaterThanOrEqual([delta histogramForTimer:RDMetricsTimerMirrorConstruction].count, 1u);
+}
+
+- (void)testRetainCount {
+    NSObject *object = [NSObject new];
+    XCTAssertEqual(RDRetainCount(nil), 0);
+    XCTAssertGreaterThanOrEqual(RDRetainCount(object), 1);
+}
+
+- (void)testRetentionPolicies {
+    RDSmoke *weakSmoke = [RDSmoke new];
+    @autoreleasepool {
+        [weakSmoke mirrorForObjcClass:NSString.self];
+    }
+    @autoreleasepool {
+        [weakSmoke mirrorForObjcClass:NSString.self];
+    }
+    XCTAssertEqual(weakSmoke.statistics.rebuilds, 1u);
+    XCTAssertEqual(weakSmoke.statistics.retainedCount, 0u);
+
+    RDSmoke *keepingSmoke = [[RDSmoke alloc] initWithRetentionPolicy:RDSmokeRetentionPolicyKeepAll byteBudget:0];
+    @autoreleasepool {
+        [keepingSmoke mirrorForObjcClass:NSString.self];
+    }
+    @autoreleasepool {
+        [keepingSmoke mirrorForObjcClass:NSString.self];
+    }
+    XCTAssertEqual(keepingSmoke.statistics.rebuilds, 0u);
+    XCTAssertGreaterThanOrEqual(keepingSmoke.statistics.hits, 1u);
+    XCTAssertGreaterThan(keepingSmoke.statistics.retainedBytes, 0u);
+    [keepingSmoke purge];
+    XCTAssertEqual(keepingSmoke.statistics.retainedCount, 0u);
+
+    RDSmoke *boundedSmoke = [[RDSmoke alloc] initWithRetentionPolicy:RDSmokeRetentionPolicyLRU byteBudget:16 * 1024];
+    @autoreleasepool {
+        for (Class cls in @[NSObject.self, NSString.self, NSArray.self, NSDictionary.self, NSNumber.self])
+            [boundedSmoke mirrorForObjcClass:cls];
+    }
+    RDSmokeStatistics statistics = boundedSmoke.statistics;
+    XCTAssertGreaterThan(statistics.evictions, 0u);
+    XCTAssertTrue(statistics.retainedBytes <= boundedSmoke.byteBudget || statistics.retainedCount == 1);
+    [boundedSmoke purge];
+
+    __weak RDClass *orphan = nil;
+    @autoreleasepool {
+        RDSmoke *droppedSmoke = [[RDSmoke alloc] initWithRetentionPolicy:RDSmokeRetentionPolicyKeepAll byteBudget:0];
+        orphan = [droppedSmoke mirrorForObjcClass:NSString.self];
+        XCTAssertTrue(orphan.smoke == droppedSmoke);
+    }
+    XCTAssertNil(orphan, @"Dropping a retaining smoke should free its mirrors without a purge");
+
+    RDClass *survivor = nil;
+    @autoreleasepool {
+        RDSmoke *droppedSmoke = [[RDSmoke alloc] initWithRetentionPolicy:RDSmokeRetentionPolicyLRU byteBudget:1 << 20];
+        survivor = [droppedSmoke mirrorForObjcClass:NSString.self];
+    }
+    XCTAssertNil(survivor.smoke);
+    NSUInteger methodCount = survivor.methods.count;
+    RDInvalidateClass(NSString.self, RDClassMembersMethods);
+    XCTAssertEqual(survivor.methods.count, methodCount, @"A mirror that outlived its smoke still rebuilds its members");
+    XCTAssertEqualObjects(survivor.super.name, @"NSObject");
+}
+
 @end